@@ -29,6 +29,31 @@ extern "C" {
 #define AES256_KEY_SIZE 8       // == 256 bits
 #define AES256_KEY_SIZE_BYTES 32// == 256 bits
 
+/// Key schedule generate 4 * (Nr + 1) words, where words is the biggest possible schedule, so Nr = 14.
+#define AES_KEY_SCHEDULE_LENGTH 60
+
+enum aes_type {
+	AES128,
+	AES192,
+	AES256,
+};
+
+/**
+ * @brief An expanded AES key, with the round keys of the cipher and of the equivalent inverse cipher.
+ */
+struct aes_ctx {
+	enum aes_type type;///< Represents the alg type
+
+	uint32_t      Nk;///< Key length (in words)
+	uint32_t      Nb;///< Block size (in words)
+	uint32_t      Nr;///< Number of rounds, 0 if no key is expanded yet
+
+	bool          inv_expanded;///< Set once inv_key_schedule is expanded, only the decryption needs it
+
+	uint32_t      key_schedule[AES_KEY_SCHEDULE_LENGTH];    ///< Key schedule of the algorithm
+	uint32_t      inv_key_schedule[AES_KEY_SCHEDULE_LENGTH];///< Key schedule of the equivalent inverse cipher
+};
+
 /* ********************** Cipher modes related functions ******************** */
 
 /**
@@ -133,6 +158,7 @@ struct cipher_ctx {
 
 	uint8_t                *key;    ///< Key used for the cipher mode
 	size_t                  key_len;///< Key length in bytes
+	struct aes_ctx          aes;    ///< AES round keys, expanded from key when it changes, see delete_cipher_context
 
 	bool                    final;///< Final context?
 
@@ -151,6 +177,15 @@ struct cipher_ctx {
 
 struct cipher_ctx *new_cipher_context(enum block_cipher algo);
 
+/**
+ * @brief Wipe the round keys held by a context, then free it.
+ *
+ * @param ctx The context, from new_cipher_context (it may be NULL).
+ *
+ * @note The key, the iv, the nonce, the plaintext and the ciphertext belong to the caller and are left untouched.
+ */
+void               delete_cipher_context(struct cipher_ctx *ctx);
+
 uint8_t           *block_cipher(struct cipher_ctx *ctx);
 uint8_t           *block_decipher(struct cipher_ctx *ctx);
 
@@ -115,28 +115,101 @@ struct blk {
 };
 
 /**
- * @brief A structure to represent a message.
- *
- * @note It may not contain all the data as the file may not be read in full.
+ * @brief CPU features the library can take advantage of at runtime.
  */
-struct msg {
-	const uint8_t *data;        ///< The data of the message.
-	__uint128_t    len;         ///< The length of the data.
-	__uint128_t    filesize;    ///< The size of the file.
-	bool           is_last_part;///< True if the message is the last part of the file.
+enum cpu_feature {
+	CPU_FEATURE_SSE2    = 1 << 0,///< SSE2 instructions
+	CPU_FEATURE_SSSE3   = 1 << 1,///< SSSE3 instructions
+	CPU_FEATURE_SSE41   = 1 << 2,///< SSE4.1 instructions
+	CPU_FEATURE_AVX2    = 1 << 3,///< AVX2 instructions (with OS support for the ymm registers)
+	CPU_FEATURE_AVX512F = 1 << 4,///< AVX-512 foundation (with OS support for the zmm registers)
+	CPU_FEATURE_SHA     = 1 << 5,///< SHA extensions (sha256rnds2, sha256msg1, sha256msg2)
+	CPU_FEATURE_AES     = 1 << 6,///< AES-NI instructions
 };
 
 /**
- * @brief Split the given data into blocks.
+ * @brief Check if the running CPU supports the given features.
+ *
+ * @param features One or several features or'ed together.
+ * @return true if all the given features are available, false otherwise.
+ *
+ * @note The CPU is probed once (using cpuid on x86), the following calls only read the cached result.
+ * @note On other architectures, this function always returns false.
+ */
+bool                cpu_has(int features) __hidden;
+
+struct hash_io_opts;
+struct hash_io_stats;
+
+/**
+ * @brief Feed data to a hash context (md5_update, sha2_update...).
+ */
+typedef void        hash_update_func(void *ctx, const uint8_t *data, size_t len);
+
+/**
+ * @brief Feed everything that is left to read from a file descriptor to a hash context.
+ *
+ * @param fd The file descriptor to hash, from its current offset.
+ * @param opts The options of the reads, or NULL for the defaults.
+ * @param update The function feeding the data to the context.
+ * @param ctx The context.
+ *
+ * @return false if the descriptor could not be read.
+ *
+ * @note Regular files are mapped in memory (by windows of 256 MiB) and given to the context straight from the
+ * mapping. The other descriptors (pipes, sockets...), and every descriptor with HASH_IO_NO_MMAP or HASH_IO_DIRECT,
+ * are read with the buffer size of the options.
+ * @note The offset of the descriptor is left at the end of the file, as if it had been read.
+ * @warning Truncating a file while it is mapped raises SIGBUS.
+ */
+bool                hash_descriptor(int fd, const struct hash_io_opts *opts, hash_update_func *update,
+                                    void *ctx) __hidden;
+
+/**
+ * @brief Feed everything that is left to read from a file descriptor to a hash context, the reads being done by
+ * a dedicated thread in a ring of buffers.
+ *
+ * @param fd The file descriptor to hash, from its current offset.
+ * @param opts The options of the reads, or NULL for the defaults.
+ * @param stats Filled with the time spent by each stage, or NULL.
+ * @param update The function feeding the data to the context, it is called on the calling thread.
+ * @param ctx The context.
+ *
+ * @return false if the descriptor could not be read.
+ * @note If the buffers cannot be allocated or the thread cannot be created, the descriptor is read on the calling
+ * thread.
+ */
+bool                hash_descriptor_pipelined(int fd, const struct hash_io_opts *opts, struct hash_io_stats *stats,
+                                              hash_update_func *update, void *ctx) __hidden;
+
+/**
+ * @brief Body of a loop run by parallel_for.
+ *
+ * @param arg The argument given to parallel_for.
+ * @param i The index of the iteration.
+ */
+typedef void        parallel_func(void *arg, size_t i);
+
+/**
+ * @brief Get the number of threads to use.
+ *
+ * @param wanted The number of threads asked by the user, or 0 for one per online CPU.
+ * @return The number of threads, between 1 and 64.
+ */
+size_t              parallel_threads(size_t wanted) __hidden;
+
+/**
+ * @brief Run the n iterations of a loop on several threads, in no particular order.
  *
- * @param data The data to split.
- * @param blk_len The length of the blocks.
- * @param wanted_size The size of the size put at the end of the last block.
- * @param le If true, the size is wanted in little endian, else in big endian.
+ * @param n The number of iterations.
+ * @param nb_threads The number of threads (including the calling one), or 0 for one per online CPU.
+ * @param func The body of the loop, it must be safe to run several iterations concurrently.
+ * @param arg The argument given to func.
  *
- * @return A pointer to a structure containing the blocks.
+ * @note The threads are created for the call and joined before returning. If they cannot be created, the
+ * iterations run on the calling thread.
  */
-struct blk         *get_blocks(const struct msg *data, size_t blk_len, size_t wanted_size, bool le) __hidden;
+void                parallel_for(size_t n, size_t nb_threads, parallel_func *func, void *arg) __hidden;
 
 /**
  * @brief Ask for a password without printing it to the terminal.
@@ -10,6 +10,7 @@
 #ifndef CRYPTO_H
 #define CRYPTO_H
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
 
@@ -17,10 +18,156 @@
 extern "C" {
 #endif
 
+/* ************************ Descriptor hashing options ************************ */
+
+#define HASH_IO_MIN_BUFFER_SIZE (1 << 16)    ///< Smallest read buffer of the `*_descriptor_opts` functions (64 KiB).
+#define HASH_IO_MAX_BUFFER_SIZE (1 << 23)    ///< Biggest read buffer of the `*_descriptor_opts` functions (8 MiB).
+#define HASH_IO_DEFAULT_BUFFER_SIZE (1 << 20)///< Read buffer used when none is given (1 MiB).
+#define HASH_IO_DEFAULT_RING_DEPTH 4          ///< Number of buffers of the pipelined functions when none is given.
+#define HASH_IO_MAX_RING_DEPTH 64             ///< Biggest number of buffers of the pipelined functions.
+
+/**
+ * @brief Flags changing how a file descriptor is read by the `*_descriptor_opts` functions.
+ */
+enum hash_io_flags {
+	HASH_IO_NO_MMAP    = 1 << 0,///< Always read the descriptor, even if it is a regular file that could be mapped.
+	HASH_IO_HUGEPAGES  = 1 << 1,///< Ask the kernel to back the mapping with huge pages (MADV_HUGEPAGE, best effort).
+	HASH_IO_DIRECT     = 1 << 2,///< Read with O_DIRECT, bypassing the page cache (implies HASH_IO_NO_MMAP).
+	HASH_IO_NO_FADVISE = 1 << 3,///< Do not announce sequential reads with posix_fadvise.
+	HASH_IO_THREADS    = 1 << 4,///< Multi-digest: always hash each algorithm on its own thread.
+	HASH_IO_NO_THREADS = 1 << 5,///< Multi-digest: hash every algorithm on the calling thread.
+};
+
+/**
+ * @brief Options of the `*_descriptor_opts` functions.
+ *
+ * @note A NULL pointer or a zeroed structure gives the defaults, which are used by the `*_descriptor` functions:
+ * regular files are mapped in memory with sequential and read-ahead hints, the other descriptors are read with
+ * a 1 MiB buffer after a POSIX_FADV_SEQUENTIAL hint.
+ * @note With HASH_IO_DIRECT, the buffer is page aligned and the reads start on a 4 KiB boundary. If the file system
+ * does not support O_DIRECT, the descriptor is read through the page cache instead.
+ */
+struct hash_io_opts {
+	int    flags;      ///< The enum hash_io_flags or'ed together.
+	size_t buffer_size;///< Size of the read buffer (clamped between 64 KiB and 8 MiB), or 0 for the default.
+	size_t ring_depth; ///< Number of buffers of the pipelined functions (between 2 and 64), or 0 for the default.
+};
+
+/**
+ * @brief Time spent by each stage of the `*_descriptor_pipelined` functions.
+ *
+ * @note If read_stall_ns is high, the reader waits for the hashing thread to free a buffer: hashing is the
+ * bottleneck and a deeper ring does not help. If hash_stall_ns is high, the I/O is the bottleneck: a deeper ring
+ * absorbs latency spikes, bigger buffers reduce the number of requests.
+ */
+struct hash_io_stats {
+	uint64_t read_ns;      ///< Time spent by the reader thread in read().
+	uint64_t read_stall_ns;///< Time the reader thread waited for a free buffer.
+	uint64_t hash_ns;      ///< Time spent hashing the buffers.
+	uint64_t hash_stall_ns;///< Time the hashing thread waited for a filled buffer.
+	size_t   nb_chunks;    ///< Number of buffers filled by the reader thread.
+};
+
 /* ************************* SHA2 related functions ************************* */
 
 enum SHA2_ALG { SHA2_ALG_224, SHA2_ALG_256, SHA2_ALG_384, SHA2_ALG_512, SHA2_ALG_512_224, SHA2_ALG_512_256 };
 
+#define SHA2_MAX_BLOCK_SIZE 128 ///< Biggest block size of the SHA2 algorithms (in bytes).
+#define SHA2_MAX_DIGEST_SIZE 64 ///< Biggest digest size of the SHA2 algorithms (in bytes).
+
+/**
+ * @brief Represents a SHA2 streaming context.
+ *
+ * @note The context is owned by the caller (it can live on the stack or be embedded in another structure),
+ * the library never allocates anything for it. Its fields should be considered private.
+ */
+struct sha2 {
+	enum SHA2_ALG alg;        ///< The algorithm.
+	size_t        digest_size;///< The size of the digest (in bytes).
+	size_t        block_size; ///< The size of a block (in bytes).
+
+	union {
+		uint32_t state_32[8];///< The chaining state (SHA2-224 and SHA2-256).
+		uint64_t state_64[8];///< The chaining state (SHA2-384, SHA2-512, SHA2-512/224 and SHA2-512/256).
+	};
+
+	uint8_t     blk[SHA2_MAX_BLOCK_SIZE];///< Bytes waiting for a full block before being compressed.
+	size_t      blk_len;                 ///< Number of bytes waiting in blk.
+	__uint128_t len;                     ///< Total number of bytes fed to the context.
+};
+
+/**
+ * @brief Setup the sha2 context depending on the given algorithm.
+ *
+ * @param ctx The context to initialize.
+ * @param alg The algorithm.
+ *
+ * @return false if the algorithm is unknown, true otherwise.
+ */
+bool				sha2_init(struct sha2 *ctx, enum SHA2_ALG alg);
+
+/**
+ * @brief Feed the context with the given data.
+ *
+ * @param ctx The context to update.
+ * @param data The data to hash.
+ * @param len The length of the data, it can be of any size.
+ *
+ * @note Full blocks are compressed directly from the given buffer, only the remaining bytes are copied
+ * into the context.
+ */
+void				sha2_update(struct sha2 *ctx, const uint8_t *data, size_t len);
+
+/**
+ * @brief Pad the message and put the final hash in the given buffer.
+ *
+ * @param ctx The context to get the hash from.
+ * @param buf The buffer to put the hash in.
+ *
+ * @return The buffer itself.
+ * @warning The given buffer must be at least `ctx->digest_size` bytes long.
+ * @note The context is wiped, it must be initialized again before being reused.
+ */
+uint8_t			   *sha2_final_raw(struct sha2 *ctx, uint8_t *buf);
+
+/**
+ * @brief Pad the message and return the final hash string.
+ *
+ * @param ctx The context to get the hash from.
+ *
+ * @return The hash string.
+ * @see sha2_final_raw
+ */
+char			   *sha2_final(struct sha2 *ctx);
+
+#define SHA2_MIDSTATE_SIZE 211///< Size of an exported SHA2 state (in bytes).
+
+/**
+ * @brief Export the state of a context, so that the hash can be resumed later, possibly in another process or on
+ * another machine.
+ *
+ * @param ctx The context, it is left untouched and can still be updated.
+ * @param buf The buffer to store the state in, SHA2_MIDSTATE_SIZE bytes long.
+ *
+ * @return The given buffer.
+ * @note The state holds the algorithm, the chaining values, the number of bytes hashed and the bytes after the last
+ * full block. It is independent of the endianness and of the layout of the context.
+ * @warning The pending bytes are stored as is: the state holds up to a block of the message in clear.
+ */
+uint8_t			   *sha2_export(const struct sha2 *ctx, uint8_t *buf);
+
+/**
+ * @brief Setup a context from a state exported by sha2_export.
+ *
+ * @param ctx The context to setup, it is updated then finalized like any other context.
+ * @param buf The exported state, SHA2_MIDSTATE_SIZE bytes long.
+ *
+ * @return false if the buffer is not an exported SHA2 state.
+ * @warning The state is not authenticated: a tampered state gives a wrong digest, it should be stored where
+ * nobody else can write it.
+ */
+bool				sha2_import(struct sha2 *ctx, const uint8_t *buf);
+
 /**
  * @brief Computes the SHA2 digest of the given string.
  *
@@ -107,6 +254,220 @@ char			   *sha2_descriptor(enum SHA2_ALG alg, int fd);
  */
 uint8_t			   *sha2_descriptor_raw(enum SHA2_ALG alg, int fd, uint8_t *buf);
 
+/**
+ * @brief Computes the SHA2 digest of a file pointed by the given file descriptor with the given read options
+ * and stores the result in the given buffer.
+ *
+ * @param alg The algorithm to use.
+ * @param fd The file descriptor of the file to hash.
+ * @param opts The read options, or NULL for the defaults.
+ * @param buf The buffer to store the result in.
+ *
+ * @return The given buffer, or NULL if the algorithm is unknown or the descriptor could not be read.
+ * @see sha2_descriptor_raw
+ */
+uint8_t			   *sha2_descriptor_opts_raw(enum SHA2_ALG alg, int fd, const struct hash_io_opts *opts, uint8_t *buf);
+
+/**
+ * @brief Computes the SHA2 digest of a file pointed by the given file descriptor, reading it on a dedicated thread,
+ * and stores the result in the given buffer.
+ *
+ * @param alg The algorithm to use.
+ * @param fd The file descriptor of the file to hash.
+ * @param opts The read options, or NULL for the defaults. The descriptor is never mapped.
+ * @param stats Filled with the time spent by each stage, or NULL.
+ * @param buf The buffer to store the result in.
+ *
+ * @return The given buffer, or NULL if the algorithm is unknown or the descriptor could not be read.
+ * @note The reader thread fills a ring of `opts->ring_depth` buffers while the calling thread hashes them, so the
+ * read of a chunk overlaps the compression of the previous ones. This helps with slow disks and network file
+ * systems, for files in the page cache sha2_descriptor_raw is faster.
+ * @see sha2_descriptor_opts_raw
+ */
+uint8_t			   *sha2_descriptor_pipelined_raw(enum SHA2_ALG alg, int fd, const struct hash_io_opts *opts,
+                                                  struct hash_io_stats *stats, uint8_t *buf);
+
+/**
+ * @brief Computes the SHA2 digests of several independent messages.
+ *
+ * @param alg The algorithm to use.
+ * @param msgs The messages to hash.
+ * @param lens The length of each message.
+ * @param n The number of messages.
+ * @param out The buffer to store the digests in, the digest of msgs[i] is stored at out + i * digest size.
+ *
+ * @return The given buffer, or NULL if the algorithm is unknown.
+ * @note The messages are hashed in parallel with SIMD instructions if the CPU supports them: 8 lanes with AVX2 and
+ * 16 with AVX-512 for SHA2-224 and SHA2-256, 4 lanes with AVX2 and 8 with AVX-512 for the other algorithms. This is
+ * meant for large batches of short messages.
+ */
+uint8_t			   *sha2_bytes_many(enum SHA2_ALG alg, const uint8_t *const *msgs, const size_t *lens, size_t n,
+                                    uint8_t *out);
+
+#define SHA2_TREE_DEFAULT_CHUNK_SIZE (1 << 20)///< Size of the chunks of the tree mode when none is given (1 MiB).
+
+/**
+ * @brief Options of the SHA2 tree mode.
+ */
+struct sha2_tree_opts {
+	size_t                     chunk_size;///< Size of the leaves (in bytes), or 0 for the default.
+	size_t                     threads;   ///< Number of threads hashing the chunks, or 0 for one per online CPU.
+	const struct hash_io_opts *io;        ///< Read options of the descriptor and file functions, or NULL.
+};
+
+/**
+ * @brief Computes the tree (Merkle) hash of the given array: the input is split into fixed size chunks which are
+ * hashed in parallel, then the chunk digests are combined two by two into a root.
+ *
+ * @param alg The algorithm to use.
+ * @param input The array to hash.
+ * @param input_size The size of the array.
+ * @param opts The options, or NULL for the defaults.
+ * @param root The buffer to store the root in (digest size of the algorithm).
+ * @param chunks If not NULL, filled with a malloc-ed array of the chunk digests, one after the other.
+ * @param nb_chunks If not NULL, filled with the number of chunks.
+ *
+ * @return The given root buffer, or NULL if the algorithm is unknown or an allocation failed.
+ *
+ * @note The tree follows the RFC 6962 (Certificate Transparency): a leaf is H(0x00 || chunk), a node is
+ * H(0x01 || left || right), and a level with an odd number of nodes promotes its last node. An empty input is a
+ * single empty chunk. The root of a single chunk is its chunk digest, so a chunk can be verified on its own by
+ * hashing it with this function.
+ * @warning The root depends on the chunk size, it is not the SHA2 digest of the input.
+ * @warning The array of the chunk digests must be freed.
+ */
+uint8_t			   *sha2_tree_bytes_raw(enum SHA2_ALG alg, const uint8_t *input, size_t input_size,
+                                        const struct sha2_tree_opts *opts, uint8_t *root, uint8_t **chunks,
+                                        size_t *nb_chunks);
+
+/**
+ * @brief Computes the tree hash of a file pointed by the given file descriptor.
+ *
+ * @return The given root buffer, or NULL if the algorithm is unknown, an allocation failed or the descriptor could
+ * not be read.
+ * @note The chunks of a mapped file are hashed in place, the other descriptors are read in batches of two chunks
+ * per thread.
+ * @see sha2_tree_bytes_raw
+ */
+uint8_t			   *sha2_tree_descriptor_raw(enum SHA2_ALG alg, int fd, const struct sha2_tree_opts *opts,
+                                             uint8_t *root, uint8_t **chunks, size_t *nb_chunks);
+
+/**
+ * @brief Computes the tree hash of the given file.
+ *
+ * @see sha2_tree_descriptor_raw
+ */
+uint8_t			   *sha2_tree_file_raw(enum SHA2_ALG alg, const char *filepath, const struct sha2_tree_opts *opts,
+                                       uint8_t *root, uint8_t **chunks, size_t *nb_chunks);
+
+#define SHA2_MERKLE_NODE_SIZE 32 ///< Size of the leaves and nodes of a Merkle tree (SHA2-256 digests).
+#define SHA2_MERKLE_MAX_PROOF 64 ///< Biggest number of nodes in an inclusion proof.
+
+/**
+ * @brief Represents a Merkle tree built over an array of SHA2-256 digests, with every level kept for the proofs.
+ *
+ * @note The fields should be considered read only, the tree is released with sha2_merkle_free.
+ */
+struct sha2_merkle {
+	uint8_t *nodes;    ///< Every level one after the other, starting with the leaves and ending with the root.
+	size_t   nb_leaves;///< Number of leaves.
+	size_t   nb_nodes; ///< Number of nodes in all the levels (leaves and root included).
+};
+
+/**
+ * @brief Build a Merkle tree over the given leaves.
+ *
+ * @param tree The tree to build.
+ * @param leaves The leaves, nb_leaves digests of SHA2_MERKLE_NODE_SIZE bytes one after the other (they are copied).
+ * @param nb_leaves The number of leaves.
+ * @param threads The number of threads hashing the wide levels, or 0 for one per online CPU.
+ *
+ * @return false if there are no leaves or an allocation failed.
+ * @note A node is SHA2-256(left || right), and a level with an odd number of nodes promotes its last node (like in
+ * RFC 6962, but without the prefixes of sha2_tree_bytes_raw). The nodes are exactly one block long, so they are
+ * hashed without any context: the block of the children then a precomputed padding block, with the multi-buffer
+ * kernels of sha2_bytes_many when the CPU supports them.
+ */
+bool				sha2_merkle_build(struct sha2_merkle *tree, const uint8_t *leaves, size_t nb_leaves,
+                                      size_t threads);
+
+/**
+ * @brief Get the root of a Merkle tree.
+ */
+static inline const uint8_t *sha2_merkle_root(const struct sha2_merkle *tree) {
+	return tree->nodes + (tree->nb_nodes - 1) * SHA2_MERKLE_NODE_SIZE;
+}
+
+/**
+ * @brief Get the inclusion proof of a leaf: the sibling of each node on the path from the leaf to the root.
+ *
+ * @param tree The tree.
+ * @param index The index of the leaf.
+ * @param proof The buffer to store the siblings in, it must hold SHA2_MERKLE_MAX_PROOF nodes.
+ * @param len Filled with the number of nodes of the proof.
+ *
+ * @return false if the index is out of the tree.
+ * @note The siblings are copied from the tree, nothing is hashed. The levels where the node is promoted have no
+ * sibling, so the length of a proof depends on the index.
+ */
+bool				sha2_merkle_proof(const struct sha2_merkle *tree, size_t index, uint8_t *proof, size_t *len);
+
+/**
+ * @brief Check an inclusion proof against a root.
+ *
+ * @param root The root of the tree.
+ * @param leaf The leaf.
+ * @param index The index of the leaf.
+ * @param nb_leaves The number of leaves of the tree.
+ * @param proof The proof given by sha2_merkle_proof.
+ * @param len The number of nodes of the proof.
+ *
+ * @return true if the leaf is at the given index of the tree.
+ */
+bool				sha2_merkle_verify(const uint8_t *root, const uint8_t *leaf, size_t index, size_t nb_leaves,
+                                       const uint8_t *proof, size_t len);
+
+/**
+ * @brief Release the nodes of a Merkle tree.
+ */
+void				sha2_merkle_free(struct sha2_merkle *tree);
+
+#define SHA2_LOG_DEFAULT_INTERVAL (1 << 24)///< Bytes between two checkpoints of a new log index (16 MiB).
+
+/**
+ * @brief Hash the bytes appended to a log since the last call, and save a checkpoint in its index every interval
+ * bytes.
+ *
+ * @param alg The algorithm.
+ * @param log_fd The log, opened for reading.
+ * @param index_fd The sidecar index of the log, opened for reading and writing. An empty file gets a new index.
+ * @param interval The number of bytes between two checkpoints of a new index, or 0 for the default. An existing
+ * index keeps its own interval.
+ *
+ * @return false if the algorithm is unknown or does not match the index, if the index is not a log index, if the
+ * log is shorter than the last checkpoint or if a read or a write failed.
+ * @note A checkpoint is the exported SHA2 state (see sha2_export) of the log after a multiple of the interval. The
+ * hashing resumes from the last checkpoint, so only the bytes after it are read. The new checkpoints are appended
+ * to the index, a partial checkpoint left by an interrupted call is overwritten.
+ * @warning The checkpoints are trusted: a log rewritten before the last checkpoint is not detected here. The index
+ * should be protected like the digests computed from it.
+ */
+bool				sha2_log_index_update(enum SHA2_ALG alg, int log_fd, int index_fd, uint64_t interval);
+
+/**
+ * @brief Compute the digest of the first bytes of a log, from the nearest checkpoint of its index.
+ *
+ * @param log_fd The log, opened for reading.
+ * @param index_fd The index of the log, as written by sha2_log_index_update.
+ * @param offset The number of bytes of the log to hash.
+ * @param buf The buffer to store the digest in.
+ *
+ * @return The given buffer, or NULL if the index is not a log index, a checkpoint is corrupted or the log is
+ * shorter than the offset.
+ * @note At most interval bytes of the log are read, plus the bytes appended after the last checkpoint.
+ */
+uint8_t			   *sha2_log_digest_raw(int log_fd, int index_fd, uint64_t offset, uint8_t *buf);
+
 /// Helper defines for the SHA2 functions above.
 static inline char *sha2_224(const char *input) {
 	return sha2(SHA2_ALG_224, input);
@@ -300,8 +661,113 @@ static inline uint8_t *sha2_512_256_descriptor_raw(int fd, uint8_t *buf) {
 	return sha2_descriptor_raw(SHA2_ALG_512_256, fd, buf);
 }
 
+static inline uint8_t *sha2_224_many(const uint8_t *const *msgs, const size_t *lens, size_t n, uint8_t *out) {
+	return sha2_bytes_many(SHA2_ALG_224, msgs, lens, n, out);
+}
+
+static inline uint8_t *sha2_256_many(const uint8_t *const *msgs, const size_t *lens, size_t n, uint8_t *out) {
+	return sha2_bytes_many(SHA2_ALG_256, msgs, lens, n, out);
+}
+
+static inline uint8_t *sha2_384_many(const uint8_t *const *msgs, const size_t *lens, size_t n, uint8_t *out) {
+	return sha2_bytes_many(SHA2_ALG_384, msgs, lens, n, out);
+}
+
+static inline uint8_t *sha2_512_many(const uint8_t *const *msgs, const size_t *lens, size_t n, uint8_t *out) {
+	return sha2_bytes_many(SHA2_ALG_512, msgs, lens, n, out);
+}
+
+static inline uint8_t *sha2_512_224_many(const uint8_t *const *msgs, const size_t *lens, size_t n, uint8_t *out) {
+	return sha2_bytes_many(SHA2_ALG_512_224, msgs, lens, n, out);
+}
+
+static inline uint8_t *sha2_512_256_many(const uint8_t *const *msgs, const size_t *lens, size_t n, uint8_t *out) {
+	return sha2_bytes_many(SHA2_ALG_512_256, msgs, lens, n, out);
+}
+
 /* ************************** MD5 related functions ************************* */
 
+#define MD5_DIGEST_SIZE 16///< Size of an MD5 digest (in bytes).
+#define MD5_BLOCK_SIZE 64 ///< Size of an MD5 block (in bytes).
+
+/**
+ * @brief Represents an MD5 streaming context.
+ *
+ * @note The context is owned by the caller (it can live on the stack or be embedded in another structure),
+ * the library never allocates anything for it. Its fields should be considered private.
+ */
+struct md5_ctx {
+	uint32_t a, b, c, d;///< Current state
+
+	uint8_t  blk[MD5_BLOCK_SIZE];///< Bytes waiting for a full block before being compressed.
+	size_t   blk_len;            ///< Number of bytes waiting in blk.
+	uint64_t len;                ///< Total number of bytes fed to the context.
+};
+
+/**
+ * @brief Initialize the MD5 context with all the values given by the RFC 1321.
+ *
+ * @param ctx The context to initialize.
+ *
+ * @see https://tools.ietf.org/html/rfc1321
+ * @warning This function must be called before any operation related to md5.
+ */
+void	 md5_init(struct md5_ctx *ctx);
+
+/**
+ * @brief Feed the context with the given data.
+ *
+ * @param ctx The context to update.
+ * @param data The data to hash.
+ * @param len The length of the data, it can be of any size.
+ *
+ * @note Full blocks are compressed directly from the given buffer, only the remaining bytes are copied
+ * into the context.
+ */
+void	 md5_update(struct md5_ctx *ctx, const uint8_t *data, size_t len);
+
+/**
+ * @brief Pad the message and put the final hash in the given buffer.
+ *
+ * @param ctx The context to get the hash from.
+ * @param output The buffer to store the hash in, at least MD5_DIGEST_SIZE bytes long.
+ *
+ * @return The given buffer.
+ * @note The context is wiped, it must be initialized again before being reused.
+ */
+uint8_t *md5_final_raw(struct md5_ctx *ctx, uint8_t *output);
+
+/**
+ * @brief Pad the message and return the final hash string.
+ *
+ * @param ctx The context to get the hash from.
+ *
+ * @return The hash string.
+ * @see md5_final_raw
+ */
+char	*md5_final(struct md5_ctx *ctx);
+
+#define MD5_MIDSTATE_SIZE 90///< Size of an exported MD5 state (in bytes).
+
+/**
+ * @brief Export the state of a context, so that the hash can be resumed later.
+ *
+ * @param ctx The context, it is left untouched and can still be updated.
+ * @param buf The buffer to store the state in, MD5_MIDSTATE_SIZE bytes long.
+ *
+ * @return The given buffer.
+ * @see sha2_export
+ */
+uint8_t *md5_export(const struct md5_ctx *ctx, uint8_t *buf);
+
+/**
+ * @brief Setup a context from a state exported by md5_export.
+ *
+ * @return false if the buffer is not an exported MD5 state.
+ * @see sha2_import
+ */
+bool	 md5_import(struct md5_ctx *ctx, const uint8_t *buf);
+
 /**
  * @brief Compute the md5 of a string given as parameter.
  *
@@ -347,6 +813,21 @@ char	*md5_bytes(const uint8_t *bytes, size_t len);
  */
 uint8_t *md5_bytes_raw(const uint8_t *bytes, size_t len, uint8_t *output);
 
+/**
+ * @brief Compute the md5 of several independent messages.
+ *
+ * @param msgs The messages to hash.
+ * @param lens The length of each message.
+ * @param n The number of messages.
+ * @param out The buffer to store the digests in, the digest of msgs[i] is stored at out + i * MD5_DIGEST_SIZE.
+ *
+ * @return The given buffer.
+ * @note The messages are hashed in parallel with SIMD instructions if the CPU supports them: 4 lanes with SSE2, 8 with
+ * AVX2 and 16 with AVX-512. This is meant for large batches of short messages.
+ * @see sha2_bytes_many
+ */
+uint8_t *md5_many(const uint8_t *const *msgs, const size_t *lens, size_t n, uint8_t *out);
+
 /**
  * @brief Compute the md5 of a file given as parameter.
  *
@@ -388,6 +869,20 @@ char	*md5_descriptor(int fd);
  */
 uint8_t *md5_descriptor_raw(int fd, uint8_t *output);
 
+/**
+ * @brief Compute the md5 of a file pointed by the file descriptor given as parameter with the given read options,
+ * and put the raw bytes in a given buffer.
+ *
+ * @param fd The file descriptor of the file to compute the md5 of.
+ * @param opts The read options, or NULL for the defaults.
+ * @param output The buffer to put the raw bytes of the md5 in.
+ *
+ * @return A copy of the output buffer, or NULL if the descriptor could not be read.
+ *
+ * @see md5_descriptor_raw
+ */
+uint8_t *md5_descriptor_opts_raw(int fd, const struct hash_io_opts *opts, uint8_t *output);
+
 #ifdef __cplusplus
 };
 #endif
@@ -0,0 +1,131 @@
+/**
+ * @file digest.h
+ * @author Ghali Boucetta (gboucett@student.42.fr)
+ * @brief Generic streaming interface over the hash functions of the library, and a multi-digest engine computing
+ * several digests of the same data in one pass.
+ * @date 2026-10-17
+ */
+
+#ifndef DIGEST_H
+#define DIGEST_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "crypto.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Every hash algorithm of the library.
+ */
+enum digest_alg {
+	DIGEST_MD5,
+	DIGEST_SHA2_224,
+	DIGEST_SHA2_256,
+	DIGEST_SHA2_384,
+	DIGEST_SHA2_512,
+	DIGEST_SHA2_512_224,
+	DIGEST_SHA2_512_256,
+};
+
+#define DIGEST_MAX_SIZE SHA2_MAX_DIGEST_SIZE     ///< Biggest digest size of the algorithms (in bytes).
+#define DIGEST_MAX_BLOCK_SIZE SHA2_MAX_BLOCK_SIZE///< Biggest block size of the algorithms (in bytes).
+
+/**
+ * @brief Represents a streaming context of any of the hash algorithms.
+ *
+ * @note Like the contexts it wraps, it is owned by the caller and its fields should be considered private.
+ */
+struct digest_ctx {
+	enum digest_alg alg;        ///< The algorithm.
+	size_t          digest_size;///< The size of the digest (in bytes).
+	size_t          block_size; ///< The size of a block (in bytes).
+
+	union {
+		struct md5_ctx md5; ///< The context of DIGEST_MD5.
+		struct sha2    sha2;///< The context of the SHA2 algorithms.
+	};
+};
+
+/**
+ * @brief Get the size of the digest of an algorithm.
+ *
+ * @return The size (in bytes), or 0 if the algorithm is unknown.
+ */
+size_t			 digest_size(enum digest_alg alg);
+
+/**
+ * @brief Setup the context depending on the given algorithm.
+ *
+ * @return false if the algorithm is unknown, true otherwise.
+ */
+bool			 digest_init(struct digest_ctx *ctx, enum digest_alg alg);
+
+/**
+ * @brief Feed the context with the given data.
+ *
+ * @see sha2_update
+ * @see md5_update
+ */
+void			 digest_update(struct digest_ctx *ctx, const uint8_t *data, size_t len);
+
+/**
+ * @brief Pad the message and put the final hash in the given buffer.
+ *
+ * @return The given buffer, which must be at least `ctx->digest_size` bytes long.
+ * @note The context is wiped, it must be initialized again before being reused.
+ */
+uint8_t			*digest_final_raw(struct digest_ctx *ctx, uint8_t *buf);
+
+#define MULTI_DIGEST_MAX 8///< Biggest number of digests computed at once by the multi-digest functions.
+
+/**
+ * @brief Compute several digests of the same bytes in one pass.
+ *
+ * @param algs The algorithms, at most MULTI_DIGEST_MAX (the same algorithm can be given several times).
+ * @param n The number of algorithms.
+ * @param opts The options, only the HASH_IO_THREADS and HASH_IO_NO_THREADS flags are used. NULL for the defaults.
+ * @param data The bytes to hash.
+ * @param len The number of bytes.
+ * @param outs The buffers to store the digests in, the digest of algs[i] is stored in outs[i].
+ *
+ * @return false if an algorithm is unknown or there are too many of them.
+ * @note The data is given to the contexts in chunks, so that each chunk is hashed by every algorithm while it is
+ * still in the cache. For large inputs, each algorithm runs on its own thread if there are several CPUs.
+ */
+bool			 multi_digest_bytes(const enum digest_alg *algs, size_t n, const struct hash_io_opts *opts,
+                                    const uint8_t *data, size_t len, uint8_t *const *outs);
+
+/**
+ * @brief Compute several digests of a file descriptor, reading it only once.
+ *
+ * @param algs The algorithms, at most MULTI_DIGEST_MAX.
+ * @param n The number of algorithms.
+ * @param fd The file descriptor to hash, from its current offset.
+ * @param opts The read options, or NULL for the defaults.
+ * @param outs The buffers to store the digests in, the digest of algs[i] is stored in outs[i].
+ *
+ * @return false if an algorithm is unknown, there are too many of them or the descriptor could not be read.
+ * @see multi_digest_bytes
+ * @see sha2_descriptor_opts_raw
+ */
+bool			 multi_digest_descriptor(const enum digest_alg *algs, size_t n, int fd,
+                                         const struct hash_io_opts *opts, uint8_t *const *outs);
+
+/**
+ * @brief Compute several digests of a file, reading it only once.
+ *
+ * @see multi_digest_descriptor
+ */
+bool			 multi_digest_file(const enum digest_alg *algs, size_t n, const char *path,
+                                   const struct hash_io_opts *opts, uint8_t *const *outs);
+
+#ifdef __cplusplus
+};
+#endif
+
+#endif
@@ -14,9 +14,12 @@
 #ifndef HMAC_H
 #define HMAC_H
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
 
+#include "crypto.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -84,11 +87,120 @@ struct hmac_req {
  *
  * @param req The HMAC request
  *
- * @return A pointer to the buffer storing the HMAC
+ * @return A pointer to the buffer storing the HMAC, or NULL if the algorithm is invalid (or on allocation failure).
  * @warning The hmac must be of sufficient size to store the result.
+ * @note The message is hashed in place when the context comes from hmac_setup, a hash function given by the user
+ * needs the padded key and the message copied in a single buffer (allocated on the heap).
+ * @see hmac_init
  */
 uint8_t *hmac(struct hmac_req req);
 
+/**
+ * @brief Hash context of any of the HMAC algorithms.
+ */
+union hmac_hash_ctx {
+	struct sha2		sha2;///< Context of the SHA2 algorithms.
+	struct md5_ctx	md5; ///< Context of MD5.
+};
+
+/**
+ * @brief A key ready to be used by HMAC.
+ *
+ * The hash contexts are kept right after their first block (the key xored with ipad or opad), so a MAC computed with
+ * the key only costs the blocks of the message and the last blocks of the outer hash.
+ *
+ * @note The key is owned by the caller, its fields should be considered private.
+ */
+struct hmac_key {
+	enum hmac_algorithm	alg;  ///< The HMAC algorithm.
+	size_t				L;	  ///< Size of the MAC (in bytes).
+
+	union hmac_hash_ctx	inner;///< Inner hash context, after the key xored with ipad.
+	union hmac_hash_ctx	outer;///< Outer hash context, after the key xored with opad.
+};
+
+/**
+ * @brief Prepare a key for the given algorithm.
+ *
+ * @param key The key to initialize.
+ * @param alg The HMAC algorithm.
+ * @param secret The secret key.
+ * @param secret_len The length of the secret key.
+ *
+ * @return false if the algorithm is unknown.
+ */
+bool hmac_key_init(struct hmac_key *key, enum hmac_algorithm alg, const uint8_t *secret, size_t secret_len);
+
+/**
+ * @brief Compute the HMAC of a message with a prepared key.
+ *
+ * @param key The key, it is left untouched and can be used for other messages (concurrently too).
+ * @param message The message.
+ * @param message_len The length of the message.
+ * @param res The buffer to store the HMAC in, key->L bytes long.
+ *
+ * @return The given buffer.
+ */
+uint8_t *hmac_key_mac(const struct hmac_key *key, const uint8_t *message, size_t message_len, uint8_t *res);
+
+/**
+ * @brief Erase a key once it is not needed anymore.
+ */
+void hmac_key_wipe(struct hmac_key *key);
+
+/**
+ * @brief Represents an HMAC streaming context.
+ *
+ * @note The context is owned by the caller, its fields should be considered private.
+ */
+struct hmac_ctx {
+	enum hmac_algorithm	alg;  ///< The HMAC algorithm.
+	size_t				L;	  ///< Size of the MAC (in bytes).
+
+	union hmac_hash_ctx	inner;///< Inner hash context, fed with the message.
+	union hmac_hash_ctx	outer;///< Outer hash context, after the key xored with opad.
+};
+
+/**
+ * @brief Initialize an HMAC context with a secret key.
+ *
+ * @param ctx The context to initialize.
+ * @param alg The HMAC algorithm.
+ * @param key The secret key.
+ * @param key_len The length of the secret key.
+ *
+ * @return false if the algorithm is unknown.
+ */
+bool hmac_init(struct hmac_ctx *ctx, enum hmac_algorithm alg, const uint8_t *key, size_t key_len);
+
+/**
+ * @brief Initialize an HMAC context with a prepared key, without hashing the key again.
+ *
+ * @param ctx The context to initialize.
+ * @param key The prepared key, it is left untouched.
+ */
+void hmac_init_key(struct hmac_ctx *ctx, const struct hmac_key *key);
+
+/**
+ * @brief Feed the context with the given data.
+ *
+ * @param ctx The context to update.
+ * @param data The data to authenticate, it is hashed in place.
+ * @param len The length of the data, it can be of any size.
+ */
+void hmac_update(struct hmac_ctx *ctx, const uint8_t *data, size_t len);
+
+/**
+ * @brief Compute the HMAC of all the data fed to the context.
+ *
+ * @param ctx The context.
+ * @param res The buffer to store the HMAC in, ctx->L bytes long.
+ *
+ * @return The given buffer.
+ * @note The context is wiped, it must be initialized again before being reused.
+ */
+uint8_t *hmac_final(struct hmac_ctx *ctx, uint8_t *res);
+
 #ifdef __cplusplus
 };
 #endif
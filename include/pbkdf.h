@@ -8,6 +8,7 @@
 #ifndef PBKDF_H
 #define PBKDF_H
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -36,6 +37,12 @@ struct pbkdf2_hmac_req {
 	 * where hLen is the length in bytes of the hash function output.
 	 */
 	uint64_t			dklen;
+
+	/**
+	 * Number of threads computing the ceil(dklen / hLen) blocks of the derived key, the calling thread included.
+	 * 0 or 1 computes them all on the calling thread.
+	 */
+	size_t				threads;
 };
 
 /**
@@ -48,6 +55,36 @@ struct pbkdf2_hmac_req {
  */
 uint8_t *pbkdf2(struct pbkdf2_hmac_req req);
 
+/**
+ * @brief PBKDF2 on several passwords at once, for bulk password verification.
+ *
+ * The iterations of independent requests run in the SIMD lanes of the SHA2 kernels when the CPU supports them
+ * (8 lanes with AVX2 and 16 with AVX-512 for SHA2-224 and SHA2-256, 4 and 8 for the other SHA2 algorithms). Each
+ * block of each derived key takes a lane. Without a kernel (or with MD5), the requests are derived one by one.
+ *
+ * @param reqs The requests, they must all use the same algorithm and number of iterations (threads is ignored).
+ * @param n The number of requests.
+ * @param dks Set to the derived keys, dks[i] is the key of reqs[i] and must be freed.
+ *
+ * @return false if the requests do not share their algorithm and number of iterations, if a dklen is 0 or too large,
+ * or on allocation failure. Every dks[i] is then NULL.
+ */
+bool	 pbkdf2_many(const struct pbkdf2_hmac_req *reqs, size_t n, uint8_t **dks);
+
+/**
+ * @brief Find the number of iterations making a derivation last the given time on this machine.
+ *
+ * The derivation is measured with an increasing number of iterations until it lasts long enough (at most 50 ms,
+ * or the budget if it is shorter), then the number of iterations is extrapolated to the budget.
+ *
+ * @param req The request to calibrate, with its algorithm, dklen and threads (its iterations are ignored). The
+ * password and the salt do not change the cost much, a typical length is enough.
+ * @param budget_ns The wanted duration of the derivation, in nanoseconds.
+ *
+ * @return The number of iterations (at least 1), or 0 if the request is invalid.
+ */
+uint32_t pbkdf2_calibrate(struct pbkdf2_hmac_req req, uint64_t budget_ns);
+
 #ifdef __cplusplus
 };
 #endif
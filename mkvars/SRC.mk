@@ -4,11 +4,24 @@ MD5_SRC_BASENAME			=	md5/md5							\
 								md5/init						\
 								md5/update						\
 								md5/final						\
+								md5/midstate					\
+								md5/lanes						\
+								md5/many						\
 
 SHA2_SRC_BASENAME			=	sha2/sha2						\
 								sha2/init						\
 								sha2/update						\
 								sha2/final						\
+								sha2/shani						\
+								sha2/lanes						\
+								sha2/many						\
+								sha2/tree						\
+								sha2/merkle						\
+								sha2/midstate					\
+								sha2/log						\
+
+DIGEST_SRC_BASENAME			=	digest/digest					\
+								digest/multi					\
 
 DES_SRC_BASENAME			=	DES/DES							\
 								DES/TDES						\
@@ -17,14 +30,19 @@ DES_SRC_BASENAME			=	DES/DES							\
 								DES/round						\
 
 AES_SRC_BASENAME			=	AES/AES							\
+								AES/aesni						\
 								AES/key							\
 								AES/steps						\
+								AES/tables						\
 
-COMMON_SRC_BASENAME			=	common/blocks					\
-								common/rand						\
+COMMON_SRC_BASENAME			=	common/rand						\
 								common/askpass					\
 								common/gensalt					\
 								common/strerror					\
+								common/cpu						\
+								common/descriptor				\
+								common/parallel					\
+								common/lanes					\
 
 CIPHER_MODE_SRC_BASENAME	=	block_cipher_modes/block_cipher_mode		\
 								block_cipher_modes/common					\
@@ -36,6 +54,7 @@ CIPHER_MODE_SRC_BASENAME	=	block_cipher_modes/block_cipher_mode		\
 
 BASENAME					:=	$(MD5_SRC_BASENAME)				\
 								$(SHA2_SRC_BASENAME)			\
+								$(DIGEST_SRC_BASENAME)			\
 								$(COMMON_SRC_BASENAME)			\
 								$(AES_SRC_BASENAME)				\
 								$(DES_SRC_BASENAME)				\
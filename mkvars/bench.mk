@@ -0,0 +1,33 @@
+ifndef PATH_OBJ
+$(error "PATH_OBJ is not defined")
+endif
+
+# Benchmarks are not part of `all`, build them with optimizations: make bench DEBUG=0 RELEASE=1
+BENCH_NAME					=	bench_crypto42
+
+BENCH_SRC					:=	$(shell find src -type f -name "*.bench.cc") $(shell find src/bench -type f -name "*.cc")
+
+BENCH_OBJ					:=	$(addprefix $(PATH_OBJ)/, $(subst $(PATH_SRC)/,,$(BENCH_SRC:.cc=.o)))
+DEPS						+=	$(addprefix $(PATH_OBJ)/, $(subst $(PATH_SRC)/,,$(BENCH_SRC:.cc=.d)))
+
+BENCH_LDFLAGS				:=	-L. -Llibft -lcrypto -lcrypto42 -lft -lm -lpthread
+
+ifeq ($(shell uname),Darwin)
+	BENCH_LDFLAGS			+=	-L/opt/homebrew/lib
+endif
+
+$(BENCH_NAME):		 CFLAGS	+= -Isrc/bench
+$(BENCH_NAME):		 CFLAGS	:= $(filter-out -Werror,$(CFLAGS))
+$(BENCH_NAME):		$(NAME) $(BENCH_OBJ)
+	$(MAKE) -C libft/
+	$(PRINTF) " $(BOLD)$(YELLOW)$(BIGGREATER)$(NORMAL)   Linking $(ITALIC)$(subst $(PATH_OBJ)/,,$@)$(TRESET)\n"
+	$(CXX) $(BENCH_OBJ) -o $(BENCH_NAME) $(BENCH_LDFLAGS)
+
+bench:				$(BENCH_NAME)
+	@./$(BENCH_NAME) $(BENCH_FILTER)
+
+# PBKDF2 iterations per second for every HMAC algorithm and number of threads, to choose an iteration count
+bench_pbkdf2:		$(BENCH_NAME)
+	@./$(BENCH_NAME) pbkdf2_rate
+
+.PHONY: bench bench_pbkdf2
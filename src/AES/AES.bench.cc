@@ -0,0 +1,112 @@
+#include "bench.hh"
+#include "cipher.h"
+#include "internal.h"
+#include <cstdlib>
+#include <vector>
+
+// Bulk traffic: 64 KiB messages under the same key, the cipher context is kept from one message to the next.
+#define MSG_SIZE (64 * 1024)
+
+static uint8_t key[AES256_KEY_SIZE_BYTES];
+static uint8_t iv[AES_BLK_SIZE_BYTES];
+
+static bool aes_block(uint8_t *(*aes)(uint8_t *, const uint8_t *), size_t iterations) {
+	uint8_t blk[AES_BLK_SIZE_BYTES] = { 0 };
+
+	for (size_t i = 0; i < iterations; i++) {
+		uint8_t *res = aes(blk, key);
+		bench::do_not_optimize(res);
+		free(res);
+	}
+	return true;
+}
+
+// Single block functions on an expanded key, without the allocation and the key schedule of aes128_encrypt.
+static bool aes_kernel(void (*aes)(const struct aes_ctx *, const uint8_t *, uint8_t *), size_t iterations) {
+	struct aes_ctx ctx {};
+	uint8_t        blk[AES_BLK_SIZE_BYTES] = { 0 };
+	uint32_t       words[AES128_KEY_SIZE]  = { 0 };
+
+	ctx.type = AES128;
+	ctx.Nk   = AES128_KEY_SIZE;
+	ctx.Nb   = AES_BLK_SIZE;
+	ctx.Nr   = AES128_NB_ROUNDS;
+	key_expansion(&ctx, words);
+	inv_key_expansion(&ctx);
+
+	// Each block depends on the previous one, like in CBC encryption.
+	for (size_t i = 0; i < iterations; i++) aes(&ctx, blk, blk);
+	bench::do_not_optimize(blk);
+	return true;
+}
+
+static bool aes_cbc(enum block_cipher algo, bool encrypt, size_t iterations) {
+	std::vector<uint8_t> msg(MSG_SIZE);
+	struct cipher_ctx   *ctx = new_cipher_context(algo);
+
+	if (!ctx)
+		return false;
+	ctx->key = key;
+	ctx->iv  = iv;
+	if (encrypt) {
+		ctx->plaintext     = msg.data();
+		ctx->plaintext_len = msg.size();
+	} else {
+		ctx->ciphertext     = msg.data();
+		ctx->ciphertext_len = msg.size();
+	}
+
+	for (size_t i = 0; i < iterations; i++) bench::do_not_optimize(encrypt ? block_cipher(ctx) : block_decipher(ctx));
+
+	free(encrypt ? ctx->ciphertext : ctx->plaintext);
+	delete_cipher_context(ctx);
+	return true;
+}
+
+BENCH(aes128_encrypt_block, AES_BLK_SIZE_BYTES) {
+	return aes_block(aes128_encrypt, iterations);
+}
+
+BENCH(aes128_decrypt_block, AES_BLK_SIZE_BYTES) {
+	return aes_block(aes128_decrypt, iterations);
+}
+
+BENCH(aes256_encrypt_block, AES_BLK_SIZE_BYTES) {
+	return aes_block(aes256_encrypt, iterations);
+}
+
+BENCH(aes128_cbc_encrypt_64KiB, MSG_SIZE) {
+	return aes_cbc(BLOCK_CIPHER_AES128_CBC, true, iterations);
+}
+
+BENCH(aes128_cbc_decrypt_64KiB, MSG_SIZE) {
+	return aes_cbc(BLOCK_CIPHER_AES128_CBC, false, iterations);
+}
+
+BENCH(aes256_cbc_encrypt_64KiB, MSG_SIZE) {
+	return aes_cbc(BLOCK_CIPHER_AES256_CBC, true, iterations);
+}
+
+BENCH(aes128_cipher_generic, AES_BLK_SIZE_BYTES) {
+	return aes_kernel(aes_cipher_generic, iterations);
+}
+
+BENCH(aes128_inv_cipher_generic, AES_BLK_SIZE_BYTES) {
+	return aes_kernel(aes_inv_cipher_generic, iterations);
+}
+
+BENCH(aes128_cipher_aesni, AES_BLK_SIZE_BYTES) {
+#ifdef AES_HAVE_AESNI
+	return cpu_has(CPU_FEATURE_AES | CPU_FEATURE_SSSE3) && aes_kernel(aes_cipher_aesni, iterations);
+#else
+	return false;
+#endif
+}
+
+BENCH(aes128_inv_cipher_aesni, AES_BLK_SIZE_BYTES) {
+#ifdef AES_HAVE_AESNI
+	return cpu_has(CPU_FEATURE_AES | CPU_FEATURE_SSSE3) && aes_kernel(aes_inv_cipher_aesni, iterations);
+#else
+	return false;
+#endif
+}
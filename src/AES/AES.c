@@ -3,80 +3,151 @@
 #include "internal.h"
 #include <string.h>
 
-typedef uint8_t *(aes_op) (struct aes_ctx *, union aes_data *, const union aes_key *);
-static aes_op cipher, inv_cipher;
-
-uint8_t      *cipher(struct aes_ctx *ctx, union aes_data *data, const union aes_key *key) {
-    key_expansion(ctx, key->w);
-
-    add_round_key(ctx, data, 0);
-
-    for (size_t i = 1; i < ctx->Nr; i++) {
-        sub_bytes(data);
-        shift_rows(data);
-        mix_columns(data);
-        add_round_key(ctx, data, i);
-    }
-    sub_bytes(data);
-    shift_rows(data);
-    add_round_key(ctx, data, ctx->Nr);
-    return data->b;
+/**
+ * @brief Load a column of the state (big endian word).
+ */
+static inline uint32_t load_be32(const uint8_t *b) {
+	return (uint32_t) b[0] << 24 | (uint32_t) b[1] << 16 | (uint32_t) b[2] << 8 | (uint32_t) b[3];
 }
 
-uint8_t *inv_cipher(struct aes_ctx *ctx, union aes_data *data, const union aes_key *key) {
-	key_expansion(ctx, key->w);
+/**
+ * @brief Store a column of the state (big endian word).
+ */
+static inline void store_be32(uint8_t *b, uint32_t w) {
+	b[0] = (uint8_t) (w >> 24);
+	b[1] = (uint8_t) (w >> 16);
+	b[2] = (uint8_t) (w >> 8);
+	b[3] = (uint8_t) w;
+}
 
-	size_t i = ctx->Nr;
+// A column of a round: the bytes of row r are taken from column sr, as ShiftRows moves them.
+#define AES_TABLE_COLUMN(t, s0, s1, s2, s3)                                                                            \
+	(t[0][(s0) >> 24] ^ t[1][((s1) >> 16) & 0xff] ^ t[2][((s2) >> 8) & 0xff] ^ t[3][(s3) &0xff])
+
+// A column of the last round, without MixColumns.
+#define AES_SBOX_COLUMN(box, s0, s1, s2, s3)                                                                           \
+	((box[(s0) >> 24] << 24) ^ (box[((s1) >> 16) & 0xff] << 16) ^ (box[((s2) >> 8) & 0xff] << 8) ^ box[(s3) &0xff])
+
+void aes_cipher_generic(const struct aes_ctx *ctx, const uint8_t *in, uint8_t *out) {
+	const uint32_t *rk = ctx->key_schedule;
+	uint32_t        s0 = load_be32(in) ^ rk[0], s1 = load_be32(in + 4) ^ rk[1];
+	uint32_t        s2 = load_be32(in + 8) ^ rk[2], s3 = load_be32(in + 12) ^ rk[3];
+	uint32_t        t0, t1, t2, t3;
+
+	for (size_t i = 1; i < ctx->Nr; i++) {
+		rk += 4;
+		t0 = AES_TABLE_COLUMN(aes_te, s0, s1, s2, s3) ^ rk[0];
+		t1 = AES_TABLE_COLUMN(aes_te, s1, s2, s3, s0) ^ rk[1];
+		t2 = AES_TABLE_COLUMN(aes_te, s2, s3, s0, s1) ^ rk[2];
+		t3 = AES_TABLE_COLUMN(aes_te, s3, s0, s1, s2) ^ rk[3];
+		s0 = t0, s1 = t1, s2 = t2, s3 = t3;
+	}
 
-	add_round_key(ctx, data, i--);
-	for (; i >= 1; i--) {
-		inv_shift_rows(data);
-		inv_sub_bytes(data);
-		add_round_key(ctx, data, i);
-		inv_mix_columns(data);
+	rk += 4;
+	store_be32(out, AES_SBOX_COLUMN(aes_sbox, s0, s1, s2, s3) ^ rk[0]);
+	store_be32(out + 4, AES_SBOX_COLUMN(aes_sbox, s1, s2, s3, s0) ^ rk[1]);
+	store_be32(out + 8, AES_SBOX_COLUMN(aes_sbox, s2, s3, s0, s1) ^ rk[2]);
+	store_be32(out + 12, AES_SBOX_COLUMN(aes_sbox, s3, s0, s1, s2) ^ rk[3]);
+}
+
+void aes_inv_cipher_generic(const struct aes_ctx *ctx, const uint8_t *in, uint8_t *out) {
+	const uint32_t *rk = ctx->inv_key_schedule;
+	uint32_t        s0 = load_be32(in) ^ rk[0], s1 = load_be32(in + 4) ^ rk[1];
+	uint32_t        s2 = load_be32(in + 8) ^ rk[2], s3 = load_be32(in + 12) ^ rk[3];
+	uint32_t        t0, t1, t2, t3;
+
+	// InvShiftRows moves the bytes the other way, row r of column c comes from column c - r.
+	for (size_t i = 1; i < ctx->Nr; i++) {
+		rk += 4;
+		t0 = AES_TABLE_COLUMN(aes_td, s0, s3, s2, s1) ^ rk[0];
+		t1 = AES_TABLE_COLUMN(aes_td, s1, s0, s3, s2) ^ rk[1];
+		t2 = AES_TABLE_COLUMN(aes_td, s2, s1, s0, s3) ^ rk[2];
+		t3 = AES_TABLE_COLUMN(aes_td, s3, s2, s1, s0) ^ rk[3];
+		s0 = t0, s1 = t1, s2 = t2, s3 = t3;
 	}
 
-	inv_shift_rows(data);
-	inv_sub_bytes(data);
-	add_round_key(ctx, data, 0);
+	rk += 4;
+	store_be32(out, AES_SBOX_COLUMN(aes_inv_sbox, s0, s3, s2, s1) ^ rk[0]);
+	store_be32(out + 4, AES_SBOX_COLUMN(aes_inv_sbox, s1, s0, s3, s2) ^ rk[1]);
+	store_be32(out + 8, AES_SBOX_COLUMN(aes_inv_sbox, s2, s1, s0, s3) ^ rk[2]);
+	store_be32(out + 12, AES_SBOX_COLUMN(aes_inv_sbox, s3, s2, s1, s0) ^ rk[3]);
+}
+
+typedef void(aes_block_func)(const struct aes_ctx *, const uint8_t *, uint8_t *);
+
+///< Implementation of the block functions and of the inverse key schedule, selected once at load time.
+static aes_block_func *aes_encrypt_block = aes_cipher_generic;
+static aes_block_func *aes_decrypt_block = aes_inv_cipher_generic;
+static void (*aes_inv_key_expansion)(struct aes_ctx *) = inv_key_expansion_generic;
 
-	return data->b;
+__attribute__((constructor)) static void aes_select_impl(void) {
+#ifdef AES_HAVE_AESNI
+	if (cpu_has(CPU_FEATURE_AES | CPU_FEATURE_SSSE3)) {
+		aes_encrypt_block     = aes_cipher_aesni;
+		aes_decrypt_block     = aes_inv_cipher_aesni;
+		aes_inv_key_expansion = inv_key_expansion_aesni;
+	}
+#endif
 }
 
-static uint8_t *do_aes(struct aes_ctx *ctx, const uint8_t *blk, const uint8_t *k, aes_op *aes) {
-	union aes_data data, blk_swp;
-	memcpy(blk_swp.w, blk, sizeof blk_swp.w);
-	blk_swp.w[0] = bswap_32(blk_swp.w[0]);
-	blk_swp.w[1] = bswap_32(blk_swp.w[1]);
-	blk_swp.w[2] = bswap_32(blk_swp.w[2]);
-	blk_swp.w[3] = bswap_32(blk_swp.w[3]);
+void aes_cipher(const struct aes_ctx *ctx, const uint8_t *in, uint8_t *out) {
+	aes_encrypt_block(ctx, in, out);
+}
 
-	for (size_t col = 0; col < 4; col++)
-		for (size_t row = 0; row < 4; row++)
-			data.b[(3 - row) * 4 + col] = blk_swp.b[(3 - col) * 4 + row];
+void aes_inv_cipher(const struct aes_ctx *ctx, const uint8_t *in, uint8_t *out) {
+	aes_decrypt_block(ctx, in, out);
+}
 
+void inv_key_expansion(struct aes_ctx *alg) {
+	aes_inv_key_expansion(alg);
+}
+
+void aes_expand_key(struct aes_ctx *ctx, enum aes_type type, const uint8_t *key, bool inverse) {
+	static const uint32_t key_sizes[] = { [AES128] = AES128_KEY_SIZE, [AES192] = AES192_KEY_SIZE,
+		                                  [AES256] = AES256_KEY_SIZE };
+	static const uint32_t rounds[]    = { [AES128] = AES128_NB_ROUNDS, [AES192] = AES192_NB_ROUNDS,
+		                                  [AES256] = AES256_NB_ROUNDS };
+
+	union aes_key words;
+	memset(words.b, 0, sizeof words.b);
+	for (size_t i = 0; i < key_sizes[type]; i++)
+		words.w[i] = load_be32(key + 4 * i);
+
+	if (ctx->Nr != rounds[type] || ctx->type != type ||
+	    memcmp(ctx->key_schedule, words.w, key_sizes[type] * sizeof *words.w)) {
+		ctx->type         = type;
+		ctx->Nk           = key_sizes[type];
+		ctx->Nb           = AES_BLK_SIZE;
+		ctx->Nr           = rounds[type];
+		ctx->inv_expanded = false;
+		key_expansion(ctx, words.w);
+	}
+	if (inverse && !ctx->inv_expanded) {
+		inv_key_expansion(ctx);
+		ctx->inv_expanded = true;
+	}
+}
+
+static uint8_t *do_aes(struct aes_ctx *ctx, const uint8_t *blk, const uint8_t *k, bool inverse) {
 	union aes_key key;
 	memset(key.b, 0, sizeof key.b);
-	memcpy(key.w, k, ctx->Nk * sizeof(*key.w));
 	for (size_t i = 0; i < ctx->Nk; i++)
-		key.w[i] = bswap_32(key.w[i]);
+		key.w[i] = load_be32(k + 4 * i);
+
+	key_expansion(ctx, key.w);
 
-	uint8_t *raw    = aes(ctx, &data, &key);
 	uint8_t *output = calloc(AES_BLK_SIZE_BYTES, sizeof *output);
 	if (!output) {
 		perror("error: couldn't allocate memory");
 		exit(EXIT_FAILURE);
 	}
 
-	for (size_t col = 0; col < 4; col++)
-		for (size_t row = 0; row < 4; row++)
-			blk_swp.b[(3 - row) * 4 + col] = raw[(3 - col) * 4 + row];
-
-	blk_swp.w[0] = bswap_32(blk_swp.w[0]);
-	blk_swp.w[1] = bswap_32(blk_swp.w[1]);
-	blk_swp.w[2] = bswap_32(blk_swp.w[2]);
-	blk_swp.w[3] = bswap_32(blk_swp.w[3]);
-	memcpy(output, blk_swp.b, sizeof blk_swp.b);
+	if (inverse) {
+		inv_key_expansion(ctx);
+		aes_inv_cipher(ctx, blk, output);
+	} else {
+		aes_cipher(ctx, blk, output);
+	}
 
 	return output;
 }
@@ -89,7 +160,7 @@ uint8_t *aes128_encrypt(uint8_t *blk, const uint8_t *k) {
 	ctx.Nk   = AES128_KEY_SIZE;
 	ctx.Nr   = AES128_NB_ROUNDS;
 
-	return do_aes(&ctx, blk, k, cipher);
+	return do_aes(&ctx, blk, k, false);
 }
 
 uint8_t *aes192_encrypt(uint8_t *blk, const uint8_t *k) {
@@ -100,7 +171,7 @@ uint8_t *aes192_encrypt(uint8_t *blk, const uint8_t *k) {
 	ctx.Nk   = AES192_KEY_SIZE;
 	ctx.Nr   = AES192_NB_ROUNDS;
 
-	return do_aes(&ctx, blk, k, cipher);
+	return do_aes(&ctx, blk, k, false);
 }
 
 uint8_t *aes256_encrypt(uint8_t *blk, const uint8_t *k) {
@@ -111,7 +182,7 @@ uint8_t *aes256_encrypt(uint8_t *blk, const uint8_t *k) {
 	ctx.Nk   = AES256_KEY_SIZE;
 	ctx.Nr   = AES256_NB_ROUNDS;
 
-	return do_aes(&ctx, blk, k, cipher);
+	return do_aes(&ctx, blk, k, false);
 }
 
 uint8_t *aes128_decrypt(uint8_t *blk, const uint8_t *k) {
@@ -122,7 +193,7 @@ uint8_t *aes128_decrypt(uint8_t *blk, const uint8_t *k) {
 	ctx.Nk   = AES128_KEY_SIZE;
 	ctx.Nr   = AES128_NB_ROUNDS;
 
-	return do_aes(&ctx, blk, k, inv_cipher);
+	return do_aes(&ctx, blk, k, true);
 }
 
 uint8_t *aes192_decrypt(uint8_t *blk, const uint8_t *k) {
@@ -133,7 +204,7 @@ uint8_t *aes192_decrypt(uint8_t *blk, const uint8_t *k) {
 	ctx.Nk   = AES192_KEY_SIZE;
 	ctx.Nr   = AES192_NB_ROUNDS;
 
-	return do_aes(&ctx, blk, k, inv_cipher);
+	return do_aes(&ctx, blk, k, true);
 }
 
 uint8_t *aes256_decrypt(uint8_t *blk, const uint8_t *k) {
@@ -144,5 +215,5 @@ uint8_t *aes256_decrypt(uint8_t *blk, const uint8_t *k) {
 	ctx.Nk   = AES256_KEY_SIZE;
 	ctx.Nr   = AES256_NB_ROUNDS;
 
-	return do_aes(&ctx, blk, k, inv_cipher);
+	return do_aes(&ctx, blk, k, true);
 }
\ No newline at end of file
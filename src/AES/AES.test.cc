@@ -1,6 +1,7 @@
 #include "cipher.h"
 #include "internal.h"
 #include "random.hh"
+#include <cstring>
 #include <gtest/gtest.h>
 #include <iostream>
 #include <map>
@@ -8,6 +9,7 @@
 #include <openssl/evp.h>
 #include <sstream>
 #include <string>
+#include <tuple>
 
 #define NB_AES_TEST 64
 
@@ -183,4 +185,76 @@ TEST_P(AES_Tests, decrypt) {
 	OPENSSL_free(expected_data);
 }
 
-typedef uint8_t *(do_aes) (uint8_t *, const uint8_t *);
\ No newline at end of file
+typedef uint8_t *(do_aes) (uint8_t *, const uint8_t *);
+// FIPS 197, appendix C: the same plaintext under the keys 00 01 02 ... of each size.
+TEST(AES, fips197_appendix_c) {
+	typedef uint8_t *(aes_func) (uint8_t *, const uint8_t *);
+
+	std::array<uint8_t, AES_BLK_SIZE_BYTES> plaintext{ 0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+		                                               0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff };
+	std::array<uint8_t, AES256_KEY_SIZE_BYTES> key{};
+	for (size_t i = 0; i < key.size(); i++) key[i] = (uint8_t) i;
+
+	const struct {
+		aes_func                               *enc, *dec;
+		std::array<uint8_t, AES_BLK_SIZE_BYTES> ciphertext;
+	} vectors[] = {
+		{ aes128_encrypt, aes128_decrypt, { 0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30, 0xd8, 0xcd, 0xb7, 0x80, 0x70,
+		                                    0xb4, 0xc5, 0x5a } },
+		{ aes192_encrypt, aes192_decrypt, { 0xdd, 0xa9, 0x7c, 0xa4, 0x86, 0x4c, 0xdf, 0xe0, 0x6e, 0xaf, 0x70, 0xa0, 0xec,
+		                                    0x0d, 0x71, 0x91 } },
+		{ aes256_encrypt, aes256_decrypt, { 0x8e, 0xa2, 0xb7, 0xca, 0x51, 0x67, 0x45, 0xbf, 0xea, 0xfc, 0x49, 0x90, 0x4b,
+		                                    0x49, 0x60, 0x89 } },
+	};
+
+	for (const auto &vector : vectors) {
+		std::shared_ptr<uint8_t> enc(vector.enc(plaintext.data(), key.data()), free);
+		std::shared_ptr<uint8_t> dec(vector.dec((uint8_t *) vector.ciphertext.data(), key.data()), free);
+
+		EXPECT_EQ(std::vector<uint8_t>(enc.get(), enc.get() + AES_BLK_SIZE_BYTES),
+		          std::vector<uint8_t>(vector.ciphertext.begin(), vector.ciphertext.end()));
+		EXPECT_EQ(std::vector<uint8_t>(dec.get(), dec.get() + AES_BLK_SIZE_BYTES),
+		          std::vector<uint8_t>(plaintext.begin(), plaintext.end()));
+	}
+}
+
+TEST(AES, aesni_matches_generic) {
+#ifdef AES_HAVE_AESNI
+	if (!cpu_has(CPU_FEATURE_AES | CPU_FEATURE_SSSE3))
+		GTEST_SKIP() << "AES-NI not supported by this CPU";
+
+	for (auto [type, Nk, Nr] : { std::make_tuple(AES128, AES128_KEY_SIZE, AES128_NB_ROUNDS),
+	                             std::make_tuple(AES192, AES192_KEY_SIZE, AES192_NB_ROUNDS),
+	                             std::make_tuple(AES256, AES256_KEY_SIZE, AES256_NB_ROUNDS) }) {
+		for (size_t i = 0; i < NB_AES_TEST; i++) {
+			struct aes_ctx generic {}, aesni {};
+			generic.type = aesni.type = type;
+			generic.Nk = aesni.Nk = Nk;
+			generic.Nb = aesni.Nb = AES_BLK_SIZE;
+			generic.Nr = aesni.Nr = Nr;
+
+			std::vector<uint32_t> key(Nk);
+			std::vector<uint8_t>  blk = rng::get_random_data(AES_BLK_SIZE_BYTES), raw = rng::get_random_data(4 * Nk);
+			memcpy(key.data(), raw.data(), 4 * Nk);
+			key_expansion(&generic, key.data());
+			key_expansion(&aesni, key.data());
+
+			inv_key_expansion_generic(&generic);
+			inv_key_expansion_aesni(&aesni);
+			EXPECT_EQ(0, memcmp(generic.inv_key_schedule, aesni.inv_key_schedule, sizeof generic.inv_key_schedule))
+				<< aes_type_translator[type];
+
+			uint8_t expected[AES_BLK_SIZE_BYTES], actual[AES_BLK_SIZE_BYTES];
+			aes_cipher_generic(&generic, blk.data(), expected);
+			aes_cipher_aesni(&aesni, blk.data(), actual);
+			EXPECT_EQ(0, memcmp(expected, actual, sizeof actual)) << aes_type_translator[type] << ", encrypt";
+
+			aes_inv_cipher_generic(&generic, blk.data(), expected);
+			aes_inv_cipher_aesni(&aesni, blk.data(), actual);
+			EXPECT_EQ(0, memcmp(expected, actual, sizeof actual)) << aes_type_translator[type] << ", decrypt";
+		}
+	}
+#else
+	GTEST_SKIP() << "AES-NI kernels not compiled in";
+#endif
+}
@@ -0,0 +1,63 @@
+/**
+ * @file aesni.c
+ * @author Ghali Boucetta (gboucett@student.42.fr)
+ * @brief AES block functions using the x86 AES-NI instructions.
+ * @date 2026-10-17
+ *
+ * The state is a single register holding the block in memory order. The key schedules of the context are big
+ * endian words, each round key is byte swapped when it is loaded, which stays out of the dependency chain of the
+ * rounds.
+ */
+
+#include "internal.h"
+
+#ifdef AES_HAVE_AESNI
+
+#	include <immintrin.h>
+
+#	define AESNI_TARGET __attribute__((target("aes,ssse3")))
+
+// Shuffle mask reversing the bytes of each 32 bits word.
+#	define AESNI_BSWAP_MASK _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3)
+
+// Round key i of the key schedule rk, in the byte order of the state.
+#	define AESNI_ROUND_KEY(rk, i) _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) ((rk) + 4 * (i))), bswap_mask)
+
+AESNI_TARGET void aes_cipher_aesni(const struct aes_ctx *ctx, const uint8_t *in, uint8_t *out) {
+	const __m128i   bswap_mask = AESNI_BSWAP_MASK;
+	const uint32_t *rk         = ctx->key_schedule;
+	__m128i         state      = _mm_xor_si128(_mm_loadu_si128((const __m128i *) in), AESNI_ROUND_KEY(rk, 0));
+
+	for (size_t i = 1; i < ctx->Nr; i++) state = _mm_aesenc_si128(state, AESNI_ROUND_KEY(rk, i));
+	state = _mm_aesenclast_si128(state, AESNI_ROUND_KEY(rk, ctx->Nr));
+	_mm_storeu_si128((__m128i *) out, state);
+}
+
+AESNI_TARGET void aes_inv_cipher_aesni(const struct aes_ctx *ctx, const uint8_t *in, uint8_t *out) {
+	const __m128i   bswap_mask = AESNI_BSWAP_MASK;
+	const uint32_t *rk         = ctx->inv_key_schedule;
+	__m128i         state      = _mm_xor_si128(_mm_loadu_si128((const __m128i *) in), AESNI_ROUND_KEY(rk, 0));
+
+	for (size_t i = 1; i < ctx->Nr; i++) state = _mm_aesdec_si128(state, AESNI_ROUND_KEY(rk, i));
+	state = _mm_aesdeclast_si128(state, AESNI_ROUND_KEY(rk, ctx->Nr));
+	_mm_storeu_si128((__m128i *) out, state);
+}
+
+AESNI_TARGET void inv_key_expansion_aesni(struct aes_ctx *alg) {
+	const __m128i bswap_mask = AESNI_BSWAP_MASK;
+	const size_t  Nr         = alg->Nr;
+
+	memset(alg->inv_key_schedule, 0, sizeof alg->inv_key_schedule);
+
+	// aesdec expects the round keys of the equivalent inverse cipher: in reverse order, InvMixColumns applied to the
+	// ones of the inner rounds.
+	for (size_t round = 0; round <= Nr; round++) {
+		__m128i key = AESNI_ROUND_KEY(alg->key_schedule, Nr - round);
+
+		if (round != 0 && round != Nr)
+			key = _mm_aesimc_si128(key);
+		_mm_storeu_si128((__m128i *) (alg->inv_key_schedule + 4 * round), _mm_shuffle_epi8(key, bswap_mask));
+	}
+}
+
+#endif
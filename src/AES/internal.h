@@ -2,6 +2,7 @@
 #define LIBCRYPTO42_INTERNAL_H
 
 #include "common.h"
+#include "common/internal.h"
 #include "cipher.h"
 
 #ifdef __cplusplus
@@ -12,14 +13,10 @@ extern "C" {
 #define AES192_NB_ROUNDS 12
 #define AES256_NB_ROUNDS 14
 
-/// Key schedule generate 4 * (Nr + 1) words, where words is the biggest possible schedule, so Nr = 14.
-#define AES_KEY_SCHEDULE_LENGTH 60
-
-enum aes_type {
-	AES128,
-	AES192,
-	AES256,
-};
+// The AES-NI kernels are compiled in on x86, they are only used if the CPU supports them.
+#if defined(__x86_64__) || defined(__i386__)
+#	define AES_HAVE_AESNI
+#endif
 
 #define AES_MAX_KEY_SIZE AES256_KEY_SIZE
 union aes_key {
@@ -28,20 +25,23 @@ union aes_key {
 };
 #undef AES_MAX_KEY_SIZE
 
-union aes_data {
-	uint32_t w[AES_BLK_SIZE];
-	uint8_t	 b[4 * AES_BLK_SIZE];
-};
-
-struct aes_ctx {
-	enum aes_type type;									/// Represents the alg type
+/**
+ * @brief Round tables of the cipher, Te0..Te3: Te0[x] holds the column (02, 01, 01, 03) * S[x] and Te1..Te3 are
+ * Te0 rotated right by 8, 16 and 24 bits, so that a round is 16 lookups on the column words.
+ */
+extern const uint32_t aes_te[4][256];
 
-	uint32_t	  Nk;									/// Key length (in bytes)
-	uint32_t	  Nb;									/// Block size (in bytes)
-	uint32_t	  Nr;									/// Number of rounds
+/**
+ * @brief Round tables of the inverse cipher, Td0..Td3: Td0[x] holds the column (0e, 09, 0d, 0b) * InvS[x] and
+ * Td1..Td3 are Td0 rotated right by 8, 16 and 24 bits.
+ */
+extern const uint32_t aes_td[4][256];
 
-	uint32_t	  key_schedule[AES_KEY_SCHEDULE_LENGTH];/// Key schedule of the algorithm
-};
+/**
+ * @brief The S-box and its inverse (FIPS 197, figures 7 and 14), used by the last round and the key schedule.
+ */
+extern const uint32_t aes_sbox[256];
+extern const uint32_t aes_inv_sbox[256];
 
 /**
  * @brief The key schedule procedure which generate a key for each round.
@@ -65,69 +65,59 @@ void	 key_expansion(struct aes_ctx *alg, const uint32_t *key);
 uint32_t sub_word(uint32_t word);
 
 /**
- * @brief This is the SUBBYTES function to perform an sbox operation on each byte of the state.
+ * @brief The key schedule of the equivalent inverse cipher, computed from the key schedule of the context.
  *
- * @param data The state
+ * @param alg Information about the current algorithm, its key schedule must be expanded.
  *
- * @note This function is described by the FIPS 197, section 5.1.1.
+ * @note This function is described by the FIPS 197, section 5.3.5.
+ * @note It uses the AES-NI instructions when the CPU supports them.
  */
-void	 sub_bytes(union aes_data *data);
+void	 inv_key_expansion(struct aes_ctx *alg);
 
 /**
- * @brief This is the INV_SUBBYTES function that reverses what SUBBYTES does.
- *
- * @param data The state.
- *
- * @note This function is described by the FIPS 197, section 5.3.2.
+ * @brief Portable inv_key_expansion, InvMixColumns is computed with the Td tables.
  */
-void	 inv_sub_bytes(union aes_data *data);
+void	 inv_key_expansion_generic(struct aes_ctx *alg);
 
 /**
- * @brief This is the ShiftRows function that do a parametric shift on each row of the state.
- *
- * @param data The state.
+ * @brief Portable aes_cipher.
  *
- * @note This function is described by the FIPS 197, section 5.1.2.
+ * @note The state is kept in 4 big endian column words, SubBytes, ShiftRows and MixColumns are done by the lookups
+ * in the Te tables (FIPS 197, section 5.1).
  */
-void	 shift_rows(union aes_data *data);
+void	 aes_cipher_generic(const struct aes_ctx *ctx, const uint8_t *in, uint8_t *out);
 
 /**
- * @brief This is the InvShiftRows function that reverses what ShiftRows does.
+ * @brief Portable aes_inv_cipher.
  *
- * @param data The state.
- *
- * @note This function is described in the FIPS 197, section 5.3.1.
+ * @note This is the equivalent inverse cipher of the FIPS 197, section 5.3.5, using the Td tables.
  */
-void	 inv_shift_rows(union aes_data *data);
+void	 aes_inv_cipher_generic(const struct aes_ctx *ctx, const uint8_t *in, uint8_t *out);
 
+#ifdef AES_HAVE_AESNI
 /**
- * @brief This is the MixColumn function of the Rijndael cipher algorithm.
- *
- * @param data The state.
+ * @brief inv_key_expansion using aesimc for InvMixColumns.
  *
- * @note This function is described by the FIPS 197, section 5.1.3.
+ * @warning This function must only be called if cpu_has(CPU_FEATURE_AES | CPU_FEATURE_SSSE3) is true.
  */
-void	 mix_columns(union aes_data *data);
+void	 inv_key_expansion_aesni(struct aes_ctx *alg);
 
 /**
- * This function is the InvMixColumns that reverses the output of the MixColumns function.
- *
- * @param data The state.
+ * @brief aes_cipher using aesenc and aesenclast.
  *
- * @note This function is described by the FIPS 197, section 5.3.3.
+ * @warning This function must only be called if cpu_has(CPU_FEATURE_AES | CPU_FEATURE_SSSE3) is true.
+ * @note The result is identical to aes_cipher_generic.
  */
-void	 inv_mix_columns(union aes_data *data);
+void	 aes_cipher_aesni(const struct aes_ctx *ctx, const uint8_t *in, uint8_t *out);
 
 /**
- * @brief This is the AddRoundKey function that combines the key schedule with the state.
+ * @brief aes_inv_cipher using aesdec and aesdeclast.
  *
- * @param ctx The algorithm context, from which we get the key schedule.
- * @param data The state.
- * @param rnd The current round.
- *
- * @note This function is described by the FIPS 197, section 5.1.4
+ * @warning This function must only be called if cpu_has(CPU_FEATURE_AES | CPU_FEATURE_SSSE3) is true.
+ * @note The result is identical to aes_inv_cipher_generic.
  */
-void	 add_round_key(struct aes_ctx *ctx, union aes_data *data, uint8_t rnd);
+void	 aes_inv_cipher_aesni(const struct aes_ctx *ctx, const uint8_t *in, uint8_t *out);
+#endif
 
 #ifdef __cplusplus
 };
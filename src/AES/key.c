@@ -57,4 +57,25 @@ void key_expansion(struct aes_ctx *alg, const uint32_t *key) {
 			res[i] = res[i - Nk] ^ temp;
 		}
 	}
-}
\ No newline at end of file
+}
+
+void inv_key_expansion_generic(struct aes_ctx *alg) {
+	const uint32_t *rk  = alg->key_schedule;
+	uint32_t       *res = alg->inv_key_schedule;
+	const uint32_t  Nr  = alg->Nr;
+
+	memset(res, 0, AES_KEY_SCHEDULE_LENGTH * sizeof *res);
+
+	// The round keys are used in reverse order, InvMixColumns is applied to the ones of the inner rounds. The
+	// InvMixColumns of a word is Td0..Td3 looked up with the S-box, as InvS[S[x]] = x.
+	for (uint32_t round = 0; round <= Nr; round++) {
+		for (uint32_t col = 0; col < 4; col++) {
+			uint32_t w = rk[4 * (Nr - round) + col];
+
+			if (round != 0 && round != Nr)
+				w = aes_td[0][aes_sbox[w >> 24]] ^ aes_td[1][aes_sbox[(w >> 16) & 0xff]] ^
+				    aes_td[2][aes_sbox[(w >> 8) & 0xff]] ^ aes_td[3][aes_sbox[w & 0xff]];
+			res[4 * round + col] = w;
+		}
+	}
+}
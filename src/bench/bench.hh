@@ -0,0 +1,50 @@
+#ifndef LIBCRYPTO42_BENCH_HH
+#define LIBCRYPTO42_BENCH_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace bench {
+	/**
+	 * @brief Workload of a benchmark, it must run its workload `iterations` times.
+	 *
+	 * @return false if the benchmark can not run on this machine (missing CPU feature for example).
+	 */
+	using func = std::function<bool(size_t iterations)>;
+
+	/**
+	 * @brief Registers a benchmark at startup, use the BENCH macro instead.
+	 */
+	struct registrar {
+		registrar(const std::string &name, size_t bytes, func f);
+		registrar(const std::string &name, size_t count, const char *unit, func f);
+	};
+
+	/**
+	 * @brief Prevents the compiler from optimizing away a value computed by a benchmark.
+	 */
+	template<typename T>
+	inline void do_not_optimize(const T &value) {
+		asm volatile("" : : "r,m"(value) : "memory");
+	}
+}// namespace bench
+
+/**
+ * @brief Defines a benchmark processing `bytes` bytes per iteration (0 if a throughput makes no sense).
+ */
+#define BENCH(name, bytes)                                                                                             \
+	static bool             bench_##name(size_t iterations);                                                           \
+	static bench::registrar registrar_##name(#name, bytes, bench_##name);                                              \
+	static bool             bench_##name(size_t iterations)
+
+/**
+ * @brief Defines a benchmark doing `count` operations per iteration, its throughput is reported in `unit` (ops/s).
+ */
+#define BENCH_RATE(name, count, unit)                                                                                  \
+	static bool             bench_##name(size_t iterations);                                                           \
+	static bench::registrar registrar_##name(#name, count, unit, bench_##name);                                        \
+	static bool             bench_##name(size_t iterations)
+
+#endif
@@ -0,0 +1,74 @@
+#include "bench.hh"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace {
+	struct entry {
+		std::string name;
+		size_t      bytes;
+		bench::func f;
+		const char *unit;// Unit of a rate benchmark, nullptr for a throughput in MB/s.
+	};
+
+	std::vector<entry> &registry() {
+		static std::vector<entry> benches;
+		return benches;
+	}
+
+	constexpr double min_duration = 0.2;// seconds per measure
+	constexpr int    nb_measures  = 5;
+
+	double run(const entry &e, size_t iterations) {
+		auto start = std::chrono::steady_clock::now();
+		e.f(iterations);
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+}// namespace
+
+bench::registrar::registrar(const std::string &name, size_t bytes, func f) {
+	registry().push_back({ name, bytes, std::move(f), nullptr });
+}
+
+bench::registrar::registrar(const std::string &name, size_t count, const char *unit, func f) {
+	registry().push_back({ name, count, std::move(f), unit });
+}
+
+/**
+ * Usage: bench_crypto42 [filter]
+ *
+ * Runs every benchmark whose name contains the filter. The number of iterations is doubled until a run lasts
+ * long enough, then the best of a few runs is reported.
+ */
+int main(int ac, char **av) {
+	const char *filter = ac > 1 ? av[1] : "";
+
+	std::sort(registry().begin(), registry().end(), [](const entry &a, const entry &b) { return a.name < b.name; });
+	printf("%-48s %14s %12s\n", "benchmark", "ns/iteration", "MB/s");
+	for (const entry &e : registry()) {
+		if (!strstr(e.name.c_str(), filter))
+			continue;
+
+		if (!e.f(1)) {
+			printf("%-48s %14s\n", e.name.c_str(), "skipped");
+			continue;
+		}
+
+		size_t iterations = 1;
+		while (run(e, iterations) < min_duration) iterations *= 2;
+
+		double best = run(e, iterations);
+		for (int i = 1; i < nb_measures; i++) best = std::min(best, run(e, iterations));
+
+		double ns = best * 1e9 / iterations;
+		if (e.unit)
+			printf("%-48s %14.1f %12.0f %s\n", e.name.c_str(), ns, e.bytes * iterations / best, e.unit);
+		else if (e.bytes)
+			printf("%-48s %14.1f %12.1f\n", e.name.c_str(), ns, e.bytes * iterations / best / 1e6);
+		else
+			printf("%-48s %14.1f %12s\n", e.name.c_str(), ns, "-");
+	}
+	return 0;
+}
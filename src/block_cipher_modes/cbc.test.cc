@@ -1,4 +1,5 @@
 #include "block_cipher_mode.hh"
+#include "random.hh"
 #include <gtest/gtest.h>
 #include <map>
 #include <string>
@@ -86,4 +87,60 @@ TEST_P(CBCTests, cipher) {
 
 TEST_P(CBCTests, decipher) {
 	run_decipher_test();
-}
\ No newline at end of file
+}
+// The AES round keys kept in the context must follow its key, even when the key is modified in place.
+TEST(CBC_Key_Tests, key_change) {
+	std::vector<uint8_t> key = rng::get_random_data(AES128_KEY_SIZE_BYTES);
+	std::vector<uint8_t> iv  = rng::get_random_data(AES_BLK_SIZE_BYTES);
+	std::vector<uint8_t> msg = rng::get_random_data(4 * AES_BLK_SIZE_BYTES);
+
+	auto encrypt = [&](struct cipher_ctx *ctx) {
+		std::vector<uint8_t> iv_copy(iv), plain(msg);
+		ctx->key           = key.data();
+		ctx->iv            = iv_copy.data();
+		ctx->plaintext     = plain.data();
+		ctx->plaintext_len = plain.size();
+
+		uint8_t *res = CBC_encrypt(ctx);
+		EXPECT_NE(res, nullptr);
+		std::vector<uint8_t> out(res, res + ctx->ciphertext_len);
+		free(ctx->ciphertext);
+		ctx->ciphertext = ctx->plaintext = nullptr;
+		ctx->ciphertext_len = ctx->plaintext_len = 0;
+		return out;
+	};
+
+	auto decrypt = [&](struct cipher_ctx *ctx, std::vector<uint8_t> cipher) {
+		std::vector<uint8_t> iv_copy(iv);
+		ctx->key            = key.data();
+		ctx->iv             = iv_copy.data();
+		ctx->ciphertext     = cipher.data();
+		ctx->ciphertext_len = cipher.size();
+
+		uint8_t *res = CBC_decrypt(ctx);
+		EXPECT_NE(res, nullptr);
+		std::vector<uint8_t> out(res, res + ctx->plaintext_len);
+		free(ctx->plaintext);
+		ctx->ciphertext = ctx->plaintext = nullptr;
+		ctx->ciphertext_len = ctx->plaintext_len = 0;
+		return out;
+	};
+
+	struct cipher_ctx   *ctx   = new_cipher_context(BLOCK_CIPHER_AES128_CBC);
+	std::vector<uint8_t> first = encrypt(ctx);
+	EXPECT_FALSE(ctx->aes.inv_expanded);// Only the decryption needs the inverse key schedule.
+	EXPECT_EQ(decrypt(ctx, first), msg);
+	EXPECT_TRUE(ctx->aes.inv_expanded);
+
+	key[0] ^= 1;
+	std::vector<uint8_t> second = encrypt(ctx);
+	EXPECT_NE(first, second);
+	EXPECT_EQ(decrypt(ctx, second), msg);
+
+	struct cipher_ctx *fresh = new_cipher_context(BLOCK_CIPHER_AES128_CBC);
+	EXPECT_EQ(encrypt(fresh), second);
+
+	delete_cipher_context(ctx);
+	delete_cipher_context(fresh);
+	delete_cipher_context(nullptr);
+}
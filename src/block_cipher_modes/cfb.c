@@ -7,6 +7,7 @@ static uint8_t *CFB_encrypt(struct cipher_ctx *ctx) {
 
 	if (!__cipher_ctx_valid(ctx, block_cipher_get_mode(ctx->algo.type), true))
 		return NULL;
+	__cipher_ctx_expand_key(ctx, false);
 
 	if (ctx->ciphertext)
 		free(ctx->ciphertext);
@@ -134,6 +135,7 @@ static uint8_t *CFB_decrypt(struct cipher_ctx *ctx) {
 
 	if (!__cipher_ctx_valid(ctx, block_cipher_get_mode(ctx->algo.type), false))
 		return NULL;
+	__cipher_ctx_expand_key(ctx, false);
 
 	if (ctx->plaintext)
 		free(ctx->plaintext);
@@ -1,6 +1,8 @@
 #include "common.h"
 #include "cipher.h"
 #include "internal.h"
+#include "common/internal.h"
+#include "libft.h"
 
 static inline struct algo get_algo(enum block_cipher cipher) {
 	union {
@@ -49,6 +51,13 @@ struct cipher_ctx *new_cipher_context(enum block_cipher algo) {
 	return ctx;
 }
 
+void delete_cipher_context(struct cipher_ctx *ctx) {
+	if (!ctx)
+		return;
+	ft_memset(&ctx->aes, 0, sizeof ctx->aes);
+	free(ctx);
+}
+
 struct block_cipher_ctx setup_algo(enum block_cipher algo) {
 	size_t           blk_size, key_size, mode_blk_size_bits;
 
@@ -122,6 +131,7 @@ struct block_cipher_ctx setup_algo(enum block_cipher algo) {
 bool __init_cipher_mode_enc(struct cipher_ctx *ctx, enum cipher_mode mode) {
 	if (!__cipher_ctx_valid(ctx, mode, true))
 		return false;
+	__cipher_ctx_expand_key(ctx, false);
 
 	if (ctx->final) {
 		if (mode == CIPHER_MODE_ECB || mode == CIPHER_MODE_CBC) {
@@ -188,6 +198,17 @@ bool __cipher_ctx_valid(struct cipher_ctx *ctx, enum cipher_mode cipher_mode, bo
 	return err == crypto42_errno;
 }
 
+void __cipher_ctx_expand_key(struct cipher_ctx *ctx, bool inverse) {
+	// The AES round keys are expanded once per key, not for every block.
+	enum algo_types type = get_block_cipher_algorithm(ctx->algo.type);
+	if (type == ALGO_TYPE_AES128)
+		aes_expand_key(&ctx->aes, AES128, ctx->key, inverse);
+	else if (type == ALGO_TYPE_AES192)
+		aes_expand_key(&ctx->aes, AES192, ctx->key, inverse);
+	else if (type == ALGO_TYPE_AES256)
+		aes_expand_key(&ctx->aes, AES256, ctx->key, inverse);
+}
+
 uint8_t *pad(uint8_t *plaintext, size_t *len, size_t blk_size) {
 	uint8_t padding = blk_size - (*len % blk_size);
 	if (!(0 < padding && padding <= 16))
@@ -471,6 +492,10 @@ void block_encrypt(const struct cipher_ctx *ctx, struct blk *res, const struct b
 	res->len = a->len;
 
 	const enum algo_types type = get_block_cipher_algorithm(ctx->algo.type);
+	if (type == ALGO_TYPE_AES128 || type == ALGO_TYPE_AES192 || type == ALGO_TYPE_AES256) {
+		aes_cipher(&ctx->aes, a->data, res->data);
+		return;
+	}
 
 	uint8_t              *fn_res = alg_op[type](a->data, ctx->key);
 	memcpy(res->data, fn_res, res->len);
@@ -486,6 +511,10 @@ void block_decrypt(const struct cipher_ctx *ctx, struct blk *res, const struct b
 	};
 
 	const enum algo_types type = get_block_cipher_algorithm(ctx->algo.type);
+	if (type == ALGO_TYPE_AES128 || type == ALGO_TYPE_AES192 || type == ALGO_TYPE_AES256) {
+		aes_inv_cipher(&ctx->aes, a->data, res->data);
+		return;
+	}
 
 	uint8_t              *fn_res = alg_op[type](a->data, ctx->key);
 	memcpy(res->data, fn_res, res->len);
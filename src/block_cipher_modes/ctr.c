@@ -77,6 +77,7 @@ uint8_t *CTR_encrypt(struct cipher_ctx *ctx) {
 
 	if (!__cipher_ctx_valid(ctx, CIPHER_MODE_CTR, true))
 		return NULL;
+	__cipher_ctx_expand_key(ctx, false);
 
 	if (ctx->ciphertext)
 		free(ctx->ciphertext);
@@ -114,6 +115,7 @@ uint8_t *CTR_decrypt(struct cipher_ctx *ctx) {
 
 	if (!__cipher_ctx_valid(ctx, CIPHER_MODE_CTR, false))
 		return NULL;
+	__cipher_ctx_expand_key(ctx, false);
 
 	if (ctx->plaintext)
 		free(ctx->plaintext);
@@ -28,6 +28,7 @@ uint8_t *ECB_encrypt(struct cipher_ctx *ctx) {
 uint8_t *ECB_decrypt(struct cipher_ctx *ctx) {
 	if (!__cipher_ctx_valid(ctx, CIPHER_MODE_ECB, false))
 		return NULL;
+	__cipher_ctx_expand_key(ctx, true);
 	if (!ctx->ciphertext_len && ctx->ciphertext == NULL)
 		return NULL;
 
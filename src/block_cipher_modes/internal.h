@@ -46,6 +46,15 @@ struct __packed algo {
  */
 bool          __cipher_ctx_valid(struct cipher_ctx *ctx, enum cipher_mode cipher_mode, bool enc) __visibility_internal;
 
+/**
+ * @brief Expand the AES key of a valid context if it changed since the last call, nothing is done for the other
+ * algorithms.
+ *
+ * @param ctx The context, checked by __cipher_ctx_valid.
+ * @param inverse True if the context is used with block_decrypt, only ECB and CBC decryption need it.
+ */
+void          __cipher_ctx_expand_key(struct cipher_ctx *ctx, bool inverse) __visibility_internal;
+
 /**
  * @brief Pad the plaintext with the given padding.
  *
@@ -107,6 +116,8 @@ struct blk *block_bit_extract(const struct blk *blk, size_t sub) __visibility_in
  * @param ctx The context from which we pull the algorithm.
  * @param res Where the result will be stored.
  * @param a The plain block to encrypt.
+ *
+ * @note The AES ciphers use the round keys expanded in the context by __cipher_ctx_expand_key.
  */
 void block_encrypt(const struct cipher_ctx *ctx, struct blk *res, const struct blk *a) __visibility_internal;
 
@@ -116,6 +127,8 @@ void block_encrypt(const struct cipher_ctx *ctx, struct blk *res, const struct b
  * @param ctx The context from which we pull the algorithm.
  * @param res Where the result will be stored.
  * @param a The plain block to decrypt.
+ *
+ * @note The AES ciphers use the inverse round keys expanded in the context by __cipher_ctx_expand_key(ctx, true).
  */
 void block_decrypt(const struct cipher_ctx *ctx, struct blk *res, const struct blk *a) __visibility_internal;
 
@@ -88,6 +88,7 @@ uint8_t *OFB_encrypt(struct cipher_ctx *ctx) {
 
 	if (!__cipher_ctx_valid(ctx, CIPHER_MODE_OFB, true))
 		return NULL;
+	__cipher_ctx_expand_key(ctx, false);
 
 	if (ctx->ciphertext)
 		free(ctx->ciphertext);
@@ -126,6 +127,7 @@ uint8_t *OFB_decrypt(struct cipher_ctx *ctx) {
 
 	if (!__cipher_ctx_valid(ctx, CIPHER_MODE_OFB, false))
 		return NULL;
+	__cipher_ctx_expand_key(ctx, false);
 
 	if (ctx->plaintext)
 		free(ctx->plaintext);
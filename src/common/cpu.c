@@ -0,0 +1,78 @@
+/**
+ * @file cpu.c
+ * @author Ghali Boucetta (gboucett@student.42.fr)
+ * @brief Runtime detection of the CPU features used to select the accelerated implementations.
+ * @date 2026-10-17
+ */
+
+#include "common.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#	include <cpuid.h>
+
+/**
+ * @brief Read the extended control register 0 to know which register states are saved by the OS.
+ *
+ * @return The value of XCR0.
+ */
+static uint64_t read_xcr0(void) {
+	uint32_t eax, edx;
+
+	__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+	return ((uint64_t) edx << 32) | eax;
+}
+
+static int probe(void) {
+	uint32_t eax, ebx, ecx, edx;
+	int      features = 0;
+
+	if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+		return 0;
+
+	if (edx & bit_SSE2)
+		features |= CPU_FEATURE_SSE2;
+	if (ecx & bit_SSSE3)
+		features |= CPU_FEATURE_SSSE3;
+	if (ecx & bit_SSE4_1)
+		features |= CPU_FEATURE_SSE41;
+	if (ecx & bit_AES)
+		features |= CPU_FEATURE_AES;
+
+	// The ymm/zmm registers are only usable if the OS saves them on context switches
+	uint64_t xcr0      = (ecx & bit_OSXSAVE) ? read_xcr0() : 0;
+	bool     os_avx    = (xcr0 & 0x06) == 0x06;// xmm and ymm states
+	bool     os_avx512 = (xcr0 & 0xe6) == 0xe6;// xmm, ymm, opmask and zmm states
+
+	if (__get_cpuid_max(0, NULL) < 7)
+		return features;
+	__cpuid_count(7, 0, eax, ebx, ecx, edx);
+
+	if ((ebx & bit_AVX2) && os_avx)
+		features |= CPU_FEATURE_AVX2;
+	if ((ebx & bit_AVX512F) && os_avx512)
+		features |= CPU_FEATURE_AVX512F;
+	if (ebx & bit_SHA)
+		features |= CPU_FEATURE_SHA;
+
+	return features;
+}
+
+#else
+
+static int probe(void) {
+	return 0;
+}
+
+#endif
+
+bool cpu_has(int features) {
+	static int cache = -1;
+	int        found = __atomic_load_n(&cache, __ATOMIC_RELAXED);
+
+	// Every thread probes the same value, so no ordering is needed beyond the atomicity of the access.
+	if (found == -1) {
+		found = probe();
+		__atomic_store_n(&cache, found, __ATOMIC_RELAXED);
+	}
+	return (found & features) == features;
+}
@@ -0,0 +1,363 @@
+/**
+ * @file descriptor.c
+ * @author Ghali Boucetta (gboucett@student.42.fr)
+ * @brief Feed the content of a file descriptor to a hash context, by mapping it in memory when possible.
+ * @date 2026-10-17
+ */
+
+#define _GNU_SOURCE
+
+#include "common.h"
+#include "crypto.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#define HASH_MMAP_MIN (1 << 16)    ///< Files smaller than this are read, mapping them costs more than it saves.
+#define HASH_MMAP_WINDOW (1 << 28) ///< Size of the windows the file is mapped with, to bound the address space used.
+
+/**
+ * @brief Get the size of the read buffer from the options, clamped to the supported range.
+ */
+static size_t hash_buffer_size(const struct hash_io_opts *opts) {
+	size_t size = opts && opts->buffer_size ? opts->buffer_size : HASH_IO_DEFAULT_BUFFER_SIZE;
+
+	if (size < HASH_IO_MIN_BUFFER_SIZE)
+		return HASH_IO_MIN_BUFFER_SIZE;
+	if (size > HASH_IO_MAX_BUFFER_SIZE)
+		return HASH_IO_MAX_BUFFER_SIZE;
+	// Direct reads need a length multiple of the logical block size, 4 KiB covers all the usual devices.
+	return size & ~(size_t) 4095;
+}
+
+/**
+ * @brief Read once from the descriptor, retrying on EINTR.
+ *
+ * @param direct true if the descriptor has O_DIRECT, it is cleared if the kernel refuses a read.
+ *
+ * @return The number of bytes read, 0 at the end of the file or -1 on error.
+ * @note Short reads are not the end of the file, only a read of 0 bytes is (the padding must be done after it).
+ */
+static ssize_t hash_read_once(int fd, uint8_t *buf, size_t size, bool *direct) {
+	ssize_t ret;
+
+	for (;;) {
+		ret = read(fd, buf, size);
+		if (ret == -1 && errno == EINTR)
+			continue;
+#ifdef O_DIRECT
+		// A short read in the middle of the file leaves the offset unaligned, the rest goes through the cache.
+		if (ret == -1 && errno == EINVAL && *direct) {
+			*direct = false;
+			if (fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_DIRECT) == -1)
+				return -1;
+			continue;
+		}
+#else
+		(void) direct;
+#endif
+		return ret;
+	}
+}
+
+/**
+ * @brief Read the descriptor until the end of the file and feed everything to the context.
+ *
+ * @return false if read failed.
+ */
+static bool hash_read(int fd, uint8_t *buf, size_t size, bool direct, hash_update_func *update, void *ctx) {
+	ssize_t ret;
+
+	while ((ret = hash_read_once(fd, buf, size, &direct)) > 0) update(ctx, buf, ret);
+	return ret == 0;
+}
+
+/**
+ * @brief Get the number of bytes to read through the page cache before the offset is aligned for O_DIRECT.
+ */
+static size_t hash_direct_head(int fd) {
+	off_t pos = lseek(fd, 0, SEEK_CUR);
+
+	return pos > 0 ? (4096 - pos % 4096) % 4096 : 0;
+}
+
+/**
+ * @brief Set O_DIRECT on the descriptor, if the file system allows it.
+ *
+ * @param fl Filled with the flags of the descriptor before the call, to restore them.
+ * @return true if the descriptor now bypasses the page cache.
+ */
+static bool hash_direct_enable(int fd, int *fl) {
+	*fl = fcntl(fd, F_GETFL);
+#ifdef O_DIRECT
+	return *fl != -1 && fcntl(fd, F_SETFL, *fl | O_DIRECT) == 0;
+#else
+	return false;
+#endif
+}
+
+/**
+ * @brief Read the descriptor bypassing the page cache (O_DIRECT), if the file system allows it.
+ *
+ * @return false if read failed.
+ */
+static bool hash_read_direct(int fd, uint8_t *buf, size_t size, hash_update_func *update, void *ctx) {
+	bool    direct = false;
+	ssize_t ret;
+	int     fl;
+
+	// Direct reads must start on an aligned offset, the head of the file is read through the cache.
+	for (size_t head = hash_direct_head(fd); head; head -= ret) {
+		if ((ret = hash_read_once(fd, buf, head, &direct)) <= 0)
+			return ret == 0;
+		update(ctx, buf, ret);
+	}
+
+	direct   = hash_direct_enable(fd, &fl);
+	bool res = hash_read(fd, buf, size, direct, update, ctx);
+	if (direct)
+		fcntl(fd, F_SETFL, fl);
+	return res;
+}
+
+/**
+ * @brief Announce sequential reads to the kernel, unless the flags say otherwise.
+ */
+static void hash_fadvise(int fd, int flags) {
+#ifdef POSIX_FADV_SEQUENTIAL
+	// Doubles the read-ahead window of regular files, it fails harmlessly on pipes and sockets.
+	if (!(flags & HASH_IO_NO_FADVISE))
+		posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#else
+	(void) fd;
+	(void) flags;
+#endif
+}
+
+/**
+ * @brief Read the descriptor with a large page aligned buffer, or a small one on the stack if the allocation fails.
+ */
+static bool hash_read_buffered(int fd, const struct hash_io_opts *opts, hash_update_func *update, void *ctx) {
+	const int    flags = opts ? opts->flags : 0;
+	const size_t size  = hash_buffer_size(opts);
+	uint8_t     *buf;
+
+	hash_fadvise(fd, flags);
+	if (posix_memalign((void **) &buf, 4096, size) != 0) {
+		uint8_t small[4096];
+		return hash_read(fd, small, sizeof small, false, update, ctx);
+	}
+
+	bool ret;
+	if (flags & HASH_IO_DIRECT)
+		ret = hash_read_direct(fd, buf, size, update, ctx);
+	else
+		ret = hash_read(fd, buf, size, false, update, ctx);
+	free(buf);
+	return ret;
+}
+
+/**
+ * @brief Map the file from pos to size window by window and feed each window to the context.
+ *
+ * @return The position of the first byte that was not hashed, it is lower than size if a mapping failed.
+ */
+static off_t hash_mmap(int fd, off_t pos, off_t size, int flags, hash_update_func *update, void *ctx) {
+	const off_t page = sysconf(_SC_PAGESIZE);
+
+	while (pos < size) {
+		// The windows are aligned on their size after the first one, so that huge pages can back them.
+		off_t start = pos & ~(page - 1);
+		off_t end   = (start / HASH_MMAP_WINDOW + 1) * HASH_MMAP_WINDOW;
+		if (end > size)
+			end = size;
+
+		uint8_t *map = mmap(NULL, end - start, PROT_READ, MAP_PRIVATE, fd, start);
+		if (map == MAP_FAILED)
+			break;
+		madvise(map, end - start, MADV_SEQUENTIAL);
+		madvise(map, end - start, MADV_WILLNEED);
+#ifdef MADV_HUGEPAGE
+		if (flags & HASH_IO_HUGEPAGES)
+			madvise(map, end - start, MADV_HUGEPAGE);
+#else
+		(void) flags;
+#endif
+
+		update(ctx, map + (pos - start), end - pos);
+		munmap(map, end - start);
+		pos = end;
+	}
+	return pos;
+}
+
+bool hash_descriptor(int fd, const struct hash_io_opts *opts, hash_update_func *update, void *ctx) {
+	const int   flags = opts ? opts->flags : 0;
+	struct stat st;
+	off_t       pos;
+
+	// Pipes, sockets, character devices and files with an unknown size (like in /proc) can only be read.
+	if ((flags & (HASH_IO_NO_MMAP | HASH_IO_DIRECT)) || fstat(fd, &st) == -1 || !S_ISREG(st.st_mode) ||
+	    (pos = lseek(fd, 0, SEEK_CUR)) == -1 || st.st_size - pos < HASH_MMAP_MIN)
+		return hash_read_buffered(fd, opts, update, ctx);
+
+	off_t end = hash_mmap(fd, pos, st.st_size, flags, update, ctx);
+	if (lseek(fd, end, SEEK_SET) == -1)
+		return false;
+	if (end < st.st_size)
+		return hash_read_buffered(fd, opts, update, ctx);
+
+	// Like read, hash what was appended to the file while it was mapped.
+	uint8_t buf[4096];
+	return hash_read(fd, buf, sizeof buf, false, update, ctx);
+}
+
+/**
+ * @brief Ring of buffers shared by the reader thread and the hashing thread of hash_descriptor_pipelined.
+ */
+struct hash_ring {
+	pthread_mutex_t      lock;  ///< Protects count, eof and error.
+	pthread_cond_t       filled;///< Signaled when the reader fills a buffer or stops.
+	pthread_cond_t       freed; ///< Signaled when the hashing thread releases a buffer.
+
+	uint8_t             *data;                         ///< The buffers, one after the other.
+	size_t               size;                         ///< The size of a buffer.
+	size_t               depth;                        ///< The number of buffers.
+	size_t               lens[HASH_IO_MAX_RING_DEPTH]; ///< The number of bytes in each filled buffer.
+	size_t               count;                        ///< The number of filled buffers waiting to be hashed.
+	bool                 eof;                          ///< Set when the reader stopped.
+	bool                 error;                        ///< Set when the reader stopped on an error.
+
+	int                  fd;    ///< The descriptor being read.
+	bool                 direct;///< true if the descriptor has O_DIRECT.
+	size_t               head;  ///< Bytes to read through the cache before enabling O_DIRECT.
+	int                  fl;    ///< The flags of the descriptor, to restore after O_DIRECT.
+
+	struct hash_io_stats stats;///< The read_* fields belong to the reader, the hash_* ones to the hashing thread.
+};
+
+/**
+ * @brief Get a monotonic time in nanoseconds.
+ */
+static uint64_t hash_now(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/**
+ * @brief Body of the reader thread: fill the free buffers of the ring in order until the end of the file.
+ */
+static void *hash_ring_reader(void *arg) {
+	struct hash_ring *ring = arg;
+
+	for (size_t slot = 0;; slot = (slot + 1) % ring->depth) {
+		uint64_t t = hash_now();
+		pthread_mutex_lock(&ring->lock);
+		while (ring->count == ring->depth) pthread_cond_wait(&ring->freed, &ring->lock);
+		pthread_mutex_unlock(&ring->lock);
+		ring->stats.read_stall_ns += hash_now() - t;
+
+		uint8_t *buf  = ring->data + slot * ring->size;
+		size_t   size = ring->head ? ring->head : ring->size;
+
+		t           = hash_now();
+		ssize_t ret = hash_read_once(ring->fd, buf, size, &ring->direct);
+		ring->stats.read_ns += hash_now() - t;
+		if (ret > 0 && ring->head && !(ring->head -= ret))
+			ring->direct = hash_direct_enable(ring->fd, &ring->fl);
+
+		pthread_mutex_lock(&ring->lock);
+		if (ret > 0) {
+			ring->lens[slot] = ret;
+			ring->count++;
+			ring->stats.nb_chunks++;
+		} else {
+			ring->eof   = true;
+			ring->error = ret == -1;
+		}
+		pthread_cond_signal(&ring->filled);
+		pthread_mutex_unlock(&ring->lock);
+		if (ret <= 0)
+			return NULL;
+	}
+}
+
+/**
+ * @brief Hash the filled buffers of the ring in order until the reader stops.
+ *
+ * @return false if the reader stopped on an error.
+ */
+static bool hash_ring_consume(struct hash_ring *ring, hash_update_func *update, void *ctx) {
+	for (size_t slot = 0;; slot = (slot + 1) % ring->depth) {
+		uint64_t t = hash_now();
+		pthread_mutex_lock(&ring->lock);
+		while (!ring->count && !ring->eof) pthread_cond_wait(&ring->filled, &ring->lock);
+		if (ring->error || !ring->count) {
+			pthread_mutex_unlock(&ring->lock);
+			return !ring->error;
+		}
+		pthread_mutex_unlock(&ring->lock);
+		ring->stats.hash_stall_ns += hash_now() - t;
+
+		t = hash_now();
+		update(ctx, ring->data + slot * ring->size, ring->lens[slot]);
+		ring->stats.hash_ns += hash_now() - t;
+
+		pthread_mutex_lock(&ring->lock);
+		ring->count--;
+		pthread_cond_signal(&ring->freed);
+		pthread_mutex_unlock(&ring->lock);
+	}
+}
+
+bool hash_descriptor_pipelined(int fd, const struct hash_io_opts *opts, struct hash_io_stats *stats,
+                               hash_update_func *update, void *ctx) {
+	const int        flags = opts ? opts->flags : 0;
+	struct hash_ring ring  = { .fd = fd };
+	pthread_t        reader;
+	bool             ret;
+
+	ring.size  = hash_buffer_size(opts);
+	ring.depth = opts && opts->ring_depth ? opts->ring_depth : HASH_IO_DEFAULT_RING_DEPTH;
+	if (ring.depth < 2)
+		ring.depth = 2;
+	if (ring.depth > HASH_IO_MAX_RING_DEPTH)
+		ring.depth = HASH_IO_MAX_RING_DEPTH;
+	if (stats)
+		*stats = (struct hash_io_stats){ 0 };
+
+	if (posix_memalign((void **) &ring.data, 4096, ring.size * ring.depth) != 0)
+		return hash_read_buffered(fd, opts, update, ctx);
+
+	hash_fadvise(fd, flags);
+	if (flags & HASH_IO_DIRECT) {
+		ring.head = hash_direct_head(fd);
+		if (!ring.head)
+			ring.direct = hash_direct_enable(fd, &ring.fl);
+	}
+
+	pthread_mutex_init(&ring.lock, NULL);
+	pthread_cond_init(&ring.filled, NULL);
+	pthread_cond_init(&ring.freed, NULL);
+	if (pthread_create(&reader, NULL, hash_ring_reader, &ring) == 0) {
+		ret = hash_ring_consume(&ring, update, ctx);
+		pthread_join(reader, NULL);
+	} else
+		ret = hash_read(fd, ring.data, ring.size, ring.direct, update, ctx);
+	pthread_cond_destroy(&ring.freed);
+	pthread_cond_destroy(&ring.filled);
+	pthread_mutex_destroy(&ring.lock);
+
+	if (ring.direct)
+		fcntl(fd, F_SETFL, ring.fl);
+	free(ring.data);
+	if (stats)
+		*stats = ring.stats;
+	return ret;
+}
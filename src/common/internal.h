@@ -0,0 +1,236 @@
+/**
+ * @file internal.h
+ * @author Ghali Boucetta (gboucett@student.42.fr)
+ * @brief Internal functions of a module used by the other modules of the library.
+ * @date 2026-10-17
+ *
+ * The modules include their own internal.h, the other modules only reach them through this file.
+ */
+
+#ifndef COMMON_INTERNAL_H
+#define COMMON_INTERNAL_H
+
+#include "cipher.h"
+#include "common.h"
+#include "crypto.h"
+#include "hmac.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LANES_MAX 16///< Biggest number of messages compressed at once by the multi-buffer kernels.
+
+/**
+ * @brief Compression function working on several messages at once (one block per lane).
+ *
+ * The chaining states are stored word by word: state[i * lanes + l] is the word i of the lane l.
+ */
+typedef void (*lanes_func)(void *state, const uint8_t *const *blks);
+
+/**
+ * @brief Single buffer compression function, on the chaining state of one message.
+ */
+typedef void (*lanes_compress_func)(void *state, const uint8_t *blks, size_t nb);
+
+/**
+ * @brief Describes a Merkle-Damgard hash function to the scheduler of the multi-buffer kernels.
+ */
+struct lanes_hash {
+	size_t              block_size; ///< Size of a block (in bytes), at most SHA2_MAX_BLOCK_SIZE.
+	size_t              len_size;   ///< Size of the length of the message ending the padding (in bytes).
+	bool                big_endian; ///< Endianness of the length and of the words of the digest.
+	size_t              word_size;  ///< Size of a word of the chaining state (4 or 8 bytes).
+	size_t              nb_words;   ///< Number of words of the chaining state, at most 8.
+	size_t              digest_size;///< Size of the digest, made of the first words of the chaining state.
+	const void         *iv;         ///< Initial chaining state.
+	lanes_compress_func compress;   ///< Single buffer compression function, used on the leftovers.
+};
+
+/**
+ * @brief Hash several messages with a multi-buffer kernel.
+ *
+ * Each lane of the kernel hashes one message, a lane is refilled with the next message as soon as its message is
+ * done. Once there are not enough messages left to keep half of the lanes busy, the remaining ones are finished
+ * with the single buffer compression function.
+ *
+ * @param hash The hash function.
+ * @param nb_lanes The number of lanes of the kernel, at most LANES_MAX.
+ * @param kernel The kernel, it must match the word size of the hash function.
+ * @param msgs The messages.
+ * @param lens The length of each message.
+ * @param n The number of messages.
+ * @param out The buffer to store the digests in (n digests stored one after the other).
+ *
+ * @return The given buffer.
+ */
+uint8_t *lanes_hash_many(const struct lanes_hash *hash, size_t nb_lanes, lanes_func kernel, const uint8_t *const *msgs,
+                         const size_t *lens, size_t n, uint8_t *out) __hidden;
+
+// Vector types of the multi-buffer kernels (GCC vector extensions).
+typedef uint32_t v4u32 __attribute__((vector_size(16)));
+typedef uint32_t v8u32 __attribute__((vector_size(32)));
+typedef uint32_t v16u32 __attribute__((vector_size(64)));
+typedef uint64_t v4u64 __attribute__((vector_size(32)));
+typedef uint64_t v8u64 __attribute__((vector_size(64)));
+
+// Indices used to interleave the first (LO) or the second (HI) halves of two vectors of n elements.
+#define VZIP_LO_4 0, 4, 1, 5
+#define VZIP_HI_4 2, 6, 3, 7
+#define VZIP_LO_8 0, 8, 1, 9, 2, 10, 3, 11
+#define VZIP_HI_8 4, 12, 5, 13, 6, 14, 7, 15
+#define VZIP_LO_16 0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23
+#define VZIP_HI_16 8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31
+
+/**
+ * @brief Load the 16 words of the blocks of each lane in dst, word i of the lane l ending in the element l of dst[i]
+ * after going through conv (a byte swap, or nothing for little endian words).
+ *
+ * Each lane's block is loaded as whole vectors, which are then transposed: interleaving the rows i and i + n / 2 into
+ * the rows 2i and 2i + 1, log2(n) times, transposes a n by n matrix. It uses __builtin_memcpy instead of ft_memcpy
+ * so that the unaligned vector loads are inlined.
+ */
+#define VLOAD_BLOCKS(vtype, lanes, dst, conv)                                                                          \
+	for (size_t chunk = 0; chunk < 16 / (lanes); chunk++) {                                                            \
+		vtype m[lanes], t[lanes];                                                                                      \
+                                                                                                                       \
+		for (size_t l = 0; l < (lanes); l++) __builtin_memcpy(m + l, blks[l] + chunk * sizeof *m, sizeof *m);          \
+		for (size_t step = 1; step < (lanes); step <<= 1) {                                                            \
+			for (size_t i = 0; i < (lanes) / 2; i++) {                                                                 \
+				t[2 * i]     = __builtin_shufflevector(m[i], m[i + (lanes) / 2], VZIP_LO_##lanes);                     \
+				t[2 * i + 1] = __builtin_shufflevector(m[i], m[i + (lanes) / 2], VZIP_HI_##lanes);                     \
+			}                                                                                                          \
+			__builtin_memcpy(m, t, sizeof m);                                                                          \
+		}                                                                                                              \
+		for (size_t i = 0; i < (lanes); i++) dst[chunk * (lanes) + i] = conv(m[i]);                                    \
+	}
+
+/**
+ * @brief Compress full blocks into the md5 context.
+ *
+ * @param ctx The context to update.
+ * @param blks The blocks to compress, they do not need to be aligned.
+ * @param nb The number of blocks.
+ *
+ * @warning This function is internal and should not be called by the user.
+ * @note This function does not touch the pending bytes nor the total length of the context.
+ */
+void md5_compress(struct md5_ctx *ctx, const uint8_t *blks, size_t nb) __visibility_internal;
+
+/**
+ * @brief Store the state of a context as a digest (little endian words).
+ *
+ * @param ctx The context, it is not padded here.
+ * @param buf The buffer to store the digest in, MD5_DIGEST_SIZE bytes long.
+ */
+void md5_store_digest(const struct md5_ctx *ctx, uint8_t *buf) __visibility_internal;
+
+/**
+ * @brief Compress full blocks into the chaining state of the context.
+ *
+ * @param ctx The context holding the chaining state.
+ * @param blks The blocks to compress, they do not need to be aligned.
+ * @param nb The number of blocks.
+ *
+ * @note This function does not touch the pending bytes nor the total length of the context.
+ */
+void sha2_compress(struct sha2 *ctx, const uint8_t *blks, size_t nb) __visibility_internal;
+
+/**
+ * @brief Store the digest from the chaining state of the context.
+ *
+ * @param ctx The context holding the final chaining state, the state is byte swapped in place.
+ * @param buf The buffer to store the digest in, it must be at least ctx->digest_size bytes long.
+ */
+void sha2_store_digest(struct sha2 *ctx, uint8_t *buf) __visibility_internal;
+
+#define SHA2_MAX_LANES LANES_MAX///< Biggest number of messages compressed at once by the SHA2 kernels.
+
+/**
+ * @brief PBKDF2 iterations (RFC 2898) working on several passwords at once.
+ *
+ * Every array holds interleaved words like the chaining states of lanes_func, the state words being the big
+ * endian words of the digest.
+ *
+ * @param t The accumulators (the xor of the U so far), updated in place.
+ * @param u The last U of each lane, replaced by the U of the last iteration.
+ * @param inner The inner midstates of the HMAC of each lane (after the key xored with ipad).
+ * @param outer The outer midstates of the HMAC of each lane (after the key xored with opad).
+ * @param mask For each of the 16 words of the block holding U, the bits of the word coming from U.
+ * @param pad For each of the 16 words of the block holding U, the padding and the length.
+ * @param iterations The number of iterations.
+ */
+typedef void (*sha2_pbkdf2_lanes_func)(void *t, void *u, const void *inner, const void *outer, const void *mask,
+                                       const void *pad, uint32_t iterations);
+
+/**
+ * @brief Describes a multi-buffer kernel.
+ */
+struct sha2_lanes {
+	size_t                 nb;      ///< Number of lanes.
+	lanes_func             compress;///< Compression function, the words are uint32_t for SHA-224 and SHA-256.
+	sha2_pbkdf2_lanes_func pbkdf2;  ///< PBKDF2 iterations.
+};
+
+/**
+ * @brief Select the best multi-buffer kernel for PBKDF2 with the algorithm on this CPU.
+ *
+ * Unlike sha2_select_lanes, the lanes are used even with the SHA extensions: the PBKDF2 kernels never load nor byte
+ * swap the blocks, so they stay faster than one password at a time.
+ *
+ * @return The kernel, or NULL if there is none.
+ */
+const struct sha2_lanes *sha2_select_pbkdf2_lanes(enum SHA2_ALG alg) __visibility_internal;
+
+/**
+ * @brief Get the SHA2 algorithm behind an HMAC algorithm.
+ *
+ * @param alg The HMAC algorithm.
+ * @param sha2_alg Where to store the SHA2 algorithm.
+ *
+ * @return false if the HMAC algorithm is not based on SHA2 (or is unknown).
+ */
+bool hmac_sha2_alg(enum hmac_algorithm alg, enum SHA2_ALG *sha2_alg) __visibility_internal;
+
+/**
+ * @brief Expand an AES key (key schedule, and the inverse key schedule if asked).
+ *
+ * @param ctx Where the round keys are stored.
+ * @param type The key size.
+ * @param key The key, its size depends on type.
+ * @param inverse If true, the inverse key schedule is expanded too, it is only needed by aes_inv_cipher.
+ *
+ * @note Nothing is expanded again if ctx already holds the round keys of this key, the key schedule starting with the
+ * key.
+ */
+void aes_expand_key(struct aes_ctx *ctx, enum aes_type type, const uint8_t *key, bool inverse) __visibility_internal;
+
+/**
+ * @brief Encrypt a single block with the key schedule of the context.
+ *
+ * @param ctx The algorithm context, from which we get the key schedule.
+ * @param in The block to encrypt.
+ * @param out Where the encrypted block is stored, it may be in.
+ *
+ * @note It uses the AES-NI instructions when the CPU supports them, the Te tables otherwise.
+ */
+void aes_cipher(const struct aes_ctx *ctx, const uint8_t *in, uint8_t *out) __visibility_internal;
+
+/**
+ * @brief Decrypt a single block with the inverse key schedule of the context.
+ *
+ * @param ctx The algorithm context, from which we get the inverse key schedule, it must be expanded.
+ * @param in The block to decrypt.
+ * @param out Where the decrypted block is stored, it may be in.
+ *
+ * @note It uses the AES-NI instructions when the CPU supports them, the Td tables otherwise.
+ */
+void aes_inv_cipher(const struct aes_ctx *ctx, const uint8_t *in, uint8_t *out) __visibility_internal;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,205 @@
+/**
+ * @file lanes.c
+ * @author Ghali Boucetta (gboucett@student.42.fr)
+ * @brief Scheduler of the multi-buffer kernels: hash a batch of independent messages, one message per lane.
+ * @date 2026-10-17
+ */
+
+#include "internal.h"
+#include "libft.h"
+
+/**
+ * @brief A message being hashed in a lane of a multi-buffer kernel.
+ */
+struct lane {
+	union {
+		uint32_t state_32[8];///< Chaining state of the message (32 bits words), up to date once the lane is flushed.
+		uint64_t state_64[8];///< Chaining state of the message (64 bits words), up to date once the lane is flushed.
+	};
+
+	size_t         msg; ///< Index of the message.
+	const uint8_t *data;///< Next block to compress.
+	size_t         nb;  ///< Number of blocks left in data.
+
+	uint8_t        tail[2 * SHA2_MAX_BLOCK_SIZE];///< Last partial block of the message followed by the padding.
+	size_t         nb_tail;                      ///< Number of blocks in tail, compressed once data is empty.
+};
+
+///< Block given to the idle lanes, their result is never used.
+static const uint8_t idle_blk[SHA2_MAX_BLOCK_SIZE];
+
+/**
+ * @brief Copy the last partial block of a message in the tail of the lane, then append the padding and the length
+ * of the message (in bits).
+ *
+ * @param hash The hash function.
+ * @param lane The lane to fill.
+ * @param rem The bytes of the message after the last full block.
+ * @param rem_len The number of bytes in rem.
+ * @param len The length of the whole message.
+ */
+static void lane_tail(const struct lanes_hash *hash, struct lane *lane, const uint8_t *rem, size_t rem_len,
+                      size_t len) {
+	const size_t blk_size = hash->block_size;
+
+	lane->nb_tail = rem_len + 1 + hash->len_size > blk_size ? 2 : 1;
+	ft_memcpy(lane->tail, rem, rem_len);
+	lane->tail[rem_len] = 0x80;// 0b10000000 (first bit after the last byte of data is always set to 1)
+	ft_memset(lane->tail + rem_len + 1, 0, lane->nb_tail * blk_size - rem_len - 1);
+
+	__uint128_t bits  = (__uint128_t) len << 3;
+	uint8_t    *field = lane->tail + lane->nb_tail * blk_size - hash->len_size;
+	for (size_t i = 0; i < hash->len_size; i++, bits >>= 8)
+		field[hash->big_endian ? hash->len_size - 1 - i : i] = (uint8_t) bits;
+}
+
+/**
+ * @brief Start hashing a message in a lane.
+ */
+static void lane_start(const struct lanes_hash *hash, struct lane *lane, size_t msg, const uint8_t *data,
+                       size_t len) {
+	ft_memcpy(lane->state_64, hash->iv, hash->nb_words * hash->word_size);
+	lane->msg  = msg;
+	lane->data = data;
+	lane->nb   = len / hash->block_size;
+	lane_tail(hash, lane, data + lane->nb * hash->block_size, len % hash->block_size, len);
+	if (lane->nb == 0) {
+		lane->data    = lane->tail;
+		lane->nb      = lane->nb_tail;
+		lane->nb_tail = 0;
+	}
+}
+
+/**
+ * @brief Move to the next block of the lane.
+ *
+ * @return true if the message of the lane is done.
+ */
+static bool lane_next(const struct lanes_hash *hash, struct lane *lane) {
+	if (--lane->nb) {
+		lane->data += hash->block_size;
+		return false;
+	}
+	if (!lane->nb_tail)
+		return true;
+	lane->data    = lane->tail;
+	lane->nb      = lane->nb_tail;
+	lane->nb_tail = 0;
+	return false;
+}
+
+/**
+ * @brief Copy the chaining state of a lane between the lane and the interleaved state of the kernel.
+ *
+ * @param hash The hash function.
+ * @param lane The lane.
+ * @param state The interleaved state of the kernel.
+ * @param l The index of the lane.
+ * @param nb_lanes The number of lanes of the kernel.
+ * @param load If true, the state of the lane is loaded in the kernel, else it is stored back in the lane.
+ */
+static void lane_state(const struct lanes_hash *hash, struct lane *lane, void *state, size_t l, size_t nb_lanes,
+                       bool load) {
+	if (hash->word_size == sizeof(uint32_t)) {
+		uint32_t *state_32 = state;
+
+		for (size_t i = 0; i < hash->nb_words; i++) {
+			if (load)
+				state_32[i * nb_lanes + l] = lane->state_32[i];
+			else
+				lane->state_32[i] = state_32[i * nb_lanes + l];
+		}
+	} else {
+		uint64_t *state_64 = state;
+
+		for (size_t i = 0; i < hash->nb_words; i++) {
+			if (load)
+				state_64[i * nb_lanes + l] = lane->state_64[i];
+			else
+				lane->state_64[i] = state_64[i * nb_lanes + l];
+		}
+	}
+}
+
+/**
+ * @brief Store the digest of a lane, the first bytes of its chaining state in the endianness of the hash function.
+ *
+ * @note The chaining state is byte swapped in place, the lane must be started again before being used.
+ */
+static void lane_digest(const struct lanes_hash *hash, struct lane *lane, uint8_t *out) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	const bool swap = !hash->big_endian;
+#else
+	const bool swap = hash->big_endian;
+#endif
+
+	for (size_t i = 0; swap && i < hash->nb_words; i++) {
+		if (hash->word_size == sizeof(uint32_t))
+			lane->state_32[i] = bswap_32(lane->state_32[i]);
+		else
+			lane->state_64[i] = bswap_64(lane->state_64[i]);
+	}
+	ft_memcpy(out, lane->state_64, hash->digest_size);
+}
+
+/**
+ * @brief Finish the message of a lane with the single buffer compression function.
+ */
+static void lane_finish(const struct lanes_hash *hash, struct lane *lane) {
+	hash->compress(lane->state_64, lane->data, lane->nb);
+	hash->compress(lane->state_64, lane->tail, lane->nb_tail);
+}
+
+uint8_t *lanes_hash_many(const struct lanes_hash *hash, size_t nb_lanes, lanes_func kernel, const uint8_t *const *msgs,
+                         const size_t *lens, size_t n, uint8_t *out) {
+	struct lane    lane[LANES_MAX];
+	bool           busy[LANES_MAX] = { false };
+	const uint8_t *blks[LANES_MAX];
+	uint64_t       state[8 * LANES_MAX];
+	size_t         next = 0, active = 0;
+
+	for (size_t l = 0; l < nb_lanes; l++) blks[l] = idle_blk;
+	for (; active < nb_lanes && next < n; active++, next++) {
+		lane_start(hash, lane + active, next, msgs[next], lens[next]);
+		lane_state(hash, lane + active, state, active, nb_lanes, true);
+		busy[active] = true;
+	}
+
+	// Keep at least half of the lanes busy, the single buffer function is faster on the leftovers.
+	while (active * 2 >= nb_lanes) {
+		for (size_t l = 0; l < nb_lanes; l++)
+			if (busy[l])
+				blks[l] = lane[l].data;
+		kernel(state, blks);
+
+		for (size_t l = 0; l < nb_lanes; l++) {
+			if (!busy[l] || !lane_next(hash, lane + l))
+				continue;
+
+			lane_state(hash, lane + l, state, l, nb_lanes, false);
+			lane_digest(hash, lane + l, out + lane[l].msg * hash->digest_size);
+			if (next < n) {
+				lane_start(hash, lane + l, next, msgs[next], lens[next]);
+				lane_state(hash, lane + l, state, l, nb_lanes, true);
+				next++;
+			} else {
+				busy[l] = false;
+				blks[l] = idle_blk;
+				active--;
+			}
+		}
+	}
+
+	for (size_t l = 0; l < nb_lanes; l++) {
+		if (!busy[l])
+			continue;
+		lane_state(hash, lane + l, state, l, nb_lanes, false);
+		lane_finish(hash, lane + l);
+		lane_digest(hash, lane + l, out + lane[l].msg * hash->digest_size);
+	}
+
+	// Setting the lanes to 0 to avoid exposing the chaining states of the messages.
+	ft_memset(lane, 0, sizeof lane);
+	ft_memset(state, 0, sizeof state);
+	return out;
+}
@@ -0,0 +1,55 @@
+/**
+ * @file parallel.c
+ * @author Ghali Boucetta (gboucett@student.42.fr)
+ * @brief Run the iterations of a loop on several threads.
+ * @date 2026-10-17
+ */
+
+#include "common.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+#define PARALLEL_MAX_THREADS 64///< Biggest number of threads used by parallel_for.
+
+/**
+ * @brief The loop shared by the threads, each one takes the next iteration until there are none left.
+ */
+struct parallel_loop {
+	parallel_func *func;///< The body of the loop.
+	void          *arg; ///< The argument of the body.
+	size_t         n;   ///< The number of iterations.
+	atomic_size_t  next;///< The next iteration to run.
+};
+
+static void *parallel_worker(void *arg) {
+	struct parallel_loop *loop = arg;
+
+	for (size_t i; (i = atomic_fetch_add_explicit(&loop->next, 1, memory_order_relaxed)) < loop->n;)
+		loop->func(loop->arg, i);
+	return NULL;
+}
+
+size_t parallel_threads(size_t wanted) {
+	if (!wanted) {
+		long online = sysconf(_SC_NPROCESSORS_ONLN);
+		wanted      = online > 0 ? (size_t) online : 1;
+	}
+	return wanted > PARALLEL_MAX_THREADS ? PARALLEL_MAX_THREADS : wanted;
+}
+
+void parallel_for(size_t n, size_t nb_threads, parallel_func *func, void *arg) {
+	struct parallel_loop loop = { .func = func, .arg = arg, .n = n };
+	pthread_t            threads[PARALLEL_MAX_THREADS];
+	size_t               started = 0;
+
+	atomic_init(&loop.next, 0);
+	nb_threads = parallel_threads(nb_threads);
+	if (nb_threads > n)
+		nb_threads = n;
+
+	// The calling thread is one of the workers, if a thread cannot be created the others take its share.
+	while (started + 1 < nb_threads && pthread_create(threads + started, NULL, parallel_worker, &loop) == 0) started++;
+	parallel_worker(&loop);
+	for (size_t i = 0; i < started; i++) pthread_join(threads[i], NULL);
+}
@@ -0,0 +1,82 @@
+/**
+ * @file digest.c
+ * @author Ghali Boucetta (gboucett@student.42.fr)
+ * @brief Generic streaming interface over the MD5 and SHA2 contexts.
+ * @date 2026-10-17
+ */
+
+#include "digest.h"
+#include "libft.h"
+
+/**
+ * @brief Get the SHA2 algorithm matching a digest algorithm.
+ *
+ * @return false if the algorithm is not a SHA2 one.
+ */
+static bool digest_sha2_alg(enum digest_alg alg, enum SHA2_ALG *sha2_alg) {
+	switch (alg) {
+	case DIGEST_SHA2_224:
+		*sha2_alg = SHA2_ALG_224;
+		return true;
+	case DIGEST_SHA2_256:
+		*sha2_alg = SHA2_ALG_256;
+		return true;
+	case DIGEST_SHA2_384:
+		*sha2_alg = SHA2_ALG_384;
+		return true;
+	case DIGEST_SHA2_512:
+		*sha2_alg = SHA2_ALG_512;
+		return true;
+	case DIGEST_SHA2_512_224:
+		*sha2_alg = SHA2_ALG_512_224;
+		return true;
+	case DIGEST_SHA2_512_256:
+		*sha2_alg = SHA2_ALG_512_256;
+		return true;
+	default:
+		return false;
+	}
+}
+
+size_t digest_size(enum digest_alg alg) {
+	struct digest_ctx ctx;
+
+	if (!digest_init(&ctx, alg))
+		return 0;
+	return ctx.digest_size;
+}
+
+bool digest_init(struct digest_ctx *ctx, enum digest_alg alg) {
+	enum SHA2_ALG sha2_alg;
+
+	ctx->alg = alg;
+	if (alg == DIGEST_MD5) {
+		md5_init(&ctx->md5);
+		ctx->digest_size = MD5_DIGEST_SIZE;
+		ctx->block_size  = MD5_BLOCK_SIZE;
+		return true;
+	}
+	if (!digest_sha2_alg(alg, &sha2_alg) || !sha2_init(&ctx->sha2, sha2_alg))
+		return false;
+	ctx->digest_size = ctx->sha2.digest_size;
+	ctx->block_size  = ctx->sha2.block_size;
+	return true;
+}
+
+void digest_update(struct digest_ctx *ctx, const uint8_t *data, size_t len) {
+	if (ctx->alg == DIGEST_MD5)
+		md5_update(&ctx->md5, data, len);
+	else
+		sha2_update(&ctx->sha2, data, len);
+}
+
+uint8_t *digest_final_raw(struct digest_ctx *ctx, uint8_t *buf) {
+	if (ctx->alg == DIGEST_MD5)
+		md5_final_raw(&ctx->md5, buf);
+	else
+		sha2_final_raw(&ctx->sha2, buf);
+
+	// Setting the context to 0 to avoid exposing the internal state of the context.
+	ft_memset(ctx, 0, sizeof *ctx);
+	return buf;
+}
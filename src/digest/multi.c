@@ -0,0 +1,228 @@
+/**
+ * @file multi.c
+ * @author Ghali Boucetta (gboucett@student.42.fr)
+ * @brief Multi-digest engine: every chunk of the input is fanned out to several contexts, optionally each one
+ * on its own thread.
+ * @date 2026-10-17
+ */
+
+#include "common.h"
+#include "digest.h"
+#include "libft.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+
+#define MULTI_DIGEST_CHUNK (1 << 18)     ///< Size of the chunks fed to the contexts, small enough to stay in the L2.
+#define MULTI_DIGEST_THREAD_MIN (1 << 16)///< Smaller updates are not worth waking up the threads.
+
+/**
+ * @brief State of the multi-digest engine.
+ */
+struct multi_digest {
+	struct digest_ctx ctx[MULTI_DIGEST_MAX];///< One context per algorithm.
+	size_t            n;                    ///< Number of contexts.
+	int               flags;                ///< The enum hash_io_flags of the options.
+
+	// The calling thread hashes ctx[0], the worker i hashes ctx[i].
+	bool              threaded;                 ///< true once the workers are started.
+	bool              start_failed;             ///< Set if the workers could not be started, they are not tried again.
+	pthread_t         workers[MULTI_DIGEST_MAX];///< The workers, workers[0] is unused.
+	pthread_mutex_t   lock;                     ///< Protects the fields below.
+	pthread_cond_t    work;                     ///< Signaled when a new chunk is published or the workers must stop.
+	pthread_cond_t    done;                     ///< Signaled when the last worker is done with the chunk.
+	const uint8_t    *data;                     ///< The published chunk.
+	size_t            len;                      ///< The length of the published chunk.
+	uint64_t          gen;                      ///< Incremented each time a chunk is published.
+	size_t            pending;                  ///< Number of workers still hashing the published chunk.
+	bool              stop;                     ///< Set to make the workers exit.
+};
+
+/**
+ * @brief Argument of a worker thread.
+ */
+struct multi_digest_worker {
+	struct multi_digest *md;
+	size_t               idx;
+};
+
+static void *multi_digest_worker(void *arg) {
+	struct multi_digest_worker *worker = arg;
+	struct multi_digest        *md     = worker->md;
+	const size_t                idx    = worker->idx;
+	uint64_t                    seen   = 0;
+
+	free(worker);
+	pthread_mutex_lock(&md->lock);
+	for (;;) {
+		while (md->gen == seen && !md->stop) pthread_cond_wait(&md->work, &md->lock);
+		if (md->stop)
+			break;
+		seen = md->gen;
+		pthread_mutex_unlock(&md->lock);
+
+		digest_update(md->ctx + idx, md->data, md->len);
+
+		pthread_mutex_lock(&md->lock);
+		if (--md->pending == 0)
+			pthread_cond_signal(&md->done);
+	}
+	pthread_mutex_unlock(&md->lock);
+	return NULL;
+}
+
+/**
+ * @brief Stop and join the workers.
+ */
+static void multi_digest_stop(struct multi_digest *md, size_t nb_workers) {
+	pthread_mutex_lock(&md->lock);
+	md->stop = true;
+	pthread_cond_broadcast(&md->work);
+	pthread_mutex_unlock(&md->lock);
+	for (size_t i = 1; i < nb_workers; i++) pthread_join(md->workers[i], NULL);
+	pthread_cond_destroy(&md->done);
+	pthread_cond_destroy(&md->work);
+	pthread_mutex_destroy(&md->lock);
+	md->threaded = false;
+}
+
+/**
+ * @brief Start one worker per context but the first one.
+ *
+ * @return false if the threads could not be created, the contexts are then all updated on the calling thread.
+ */
+static bool multi_digest_start(struct multi_digest *md) {
+	size_t i = 1;
+
+	pthread_mutex_init(&md->lock, NULL);
+	pthread_cond_init(&md->work, NULL);
+	pthread_cond_init(&md->done, NULL);
+	md->gen  = 0;
+	md->stop = false;
+	for (; i < md->n; i++) {
+		struct multi_digest_worker *worker = malloc(sizeof *worker);
+		if (!worker)
+			break;
+		*worker = (struct multi_digest_worker){ .md = md, .idx = i };
+		if (pthread_create(md->workers + i, NULL, multi_digest_worker, worker) != 0) {
+			free(worker);
+			break;
+		}
+	}
+	md->threaded = true;
+	if (i < md->n) {
+		multi_digest_stop(md, i);
+		md->start_failed = true;
+	}
+	return md->threaded;
+}
+
+/**
+ * @brief Check if the contexts should be updated on their own threads.
+ */
+static bool multi_digest_want_threads(const struct multi_digest *md, size_t len) {
+	if (md->start_failed || md->n < 2 || len < MULTI_DIGEST_THREAD_MIN || (md->flags & HASH_IO_NO_THREADS))
+		return false;
+	return (md->flags & HASH_IO_THREADS) || sysconf(_SC_NPROCESSORS_ONLN) > 1;
+}
+
+/**
+ * @brief Feed a chunk to every context.
+ */
+static void multi_digest_chunk(struct multi_digest *md, const uint8_t *data, size_t len) {
+	if (!md->threaded && multi_digest_want_threads(md, len))
+		multi_digest_start(md);
+
+	if (!md->threaded || len < MULTI_DIGEST_THREAD_MIN) {
+		for (size_t i = 0; i < md->n; i++) digest_update(md->ctx + i, data, len);
+		return;
+	}
+
+	pthread_mutex_lock(&md->lock);
+	md->data    = data;
+	md->len     = len;
+	md->pending = md->n - 1;
+	md->gen++;
+	pthread_cond_broadcast(&md->work);
+	pthread_mutex_unlock(&md->lock);
+
+	digest_update(md->ctx, data, len);
+
+	pthread_mutex_lock(&md->lock);
+	while (md->pending) pthread_cond_wait(&md->done, &md->lock);
+	pthread_mutex_unlock(&md->lock);
+}
+
+/**
+ * @brief Feed data to every context, by chunks.
+ */
+static void multi_digest_update(void *ctx, const uint8_t *data, size_t len) {
+	struct multi_digest *md = ctx;
+
+	// Threads share a chunk once, serial contexts take turns on chunks that are still in the cache.
+	size_t chunk = md->threaded || multi_digest_want_threads(md, len) ? HASH_IO_MAX_BUFFER_SIZE : MULTI_DIGEST_CHUNK;
+	for (size_t off = 0; off < len; off += chunk)
+		multi_digest_chunk(md, data + off, len - off < chunk ? len - off : chunk);
+}
+
+/**
+ * @brief Initialize the contexts of the engine.
+ *
+ * @return false if an algorithm is unknown or there are too many of them.
+ */
+static bool multi_digest_init(struct multi_digest *md, const enum digest_alg *algs, size_t n,
+                              const struct hash_io_opts *opts) {
+	if (n > MULTI_DIGEST_MAX)
+		return false;
+
+	md->n            = n;
+	md->flags        = opts ? opts->flags : 0;
+	md->threaded     = false;
+	md->start_failed = false;
+	for (size_t i = 0; i < n; i++)
+		if (!digest_init(md->ctx + i, algs[i]))
+			return false;
+	return true;
+}
+
+/**
+ * @brief Stop the workers, then store the digests or wipe the contexts.
+ *
+ * @return ok
+ */
+static bool multi_digest_final(struct multi_digest *md, bool ok, uint8_t *const *outs) {
+	if (md->threaded)
+		multi_digest_stop(md, md->n);
+	for (size_t i = 0; i < md->n && ok; i++) digest_final_raw(md->ctx + i, outs[i]);
+	ft_memset(md->ctx, 0, sizeof md->ctx);
+	return ok;
+}
+
+bool multi_digest_bytes(const enum digest_alg *algs, size_t n, const struct hash_io_opts *opts, const uint8_t *data,
+                        size_t len, uint8_t *const *outs) {
+	struct multi_digest md;
+
+	if (!multi_digest_init(&md, algs, n, opts))
+		return false;
+	multi_digest_update(&md, data, len);
+	return multi_digest_final(&md, true, outs);
+}
+
+bool multi_digest_descriptor(const enum digest_alg *algs, size_t n, int fd, const struct hash_io_opts *opts,
+                             uint8_t *const *outs) {
+	struct multi_digest md;
+
+	if (!multi_digest_init(&md, algs, n, opts))
+		return false;
+	return multi_digest_final(&md, hash_descriptor(fd, opts, multi_digest_update, &md), outs);
+}
+
+bool multi_digest_file(const enum digest_alg *algs, size_t n, const char *path, const struct hash_io_opts *opts,
+                       uint8_t *const *outs) {
+	int fd = open(path, O_RDONLY);
+	if (fd == -1)
+		return false;
+	bool ret = multi_digest_descriptor(algs, n, fd, opts, outs);
+	close(fd);
+	return ret;
+}
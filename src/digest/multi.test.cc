@@ -0,0 +1,114 @@
+#include "digest.h"
+#include "random.hh"
+#include <cstdio>
+#include <gtest/gtest.h>
+#include <openssl/evp.h>
+#include <unistd.h>
+#include <vector>
+
+static const EVP_MD *digest_evp(enum digest_alg alg) {
+	switch (alg) {
+	case DIGEST_MD5:
+		return EVP_md5();
+	case DIGEST_SHA2_224:
+		return EVP_sha224();
+	case DIGEST_SHA2_256:
+		return EVP_sha256();
+	case DIGEST_SHA2_384:
+		return EVP_sha384();
+	case DIGEST_SHA2_512:
+		return EVP_sha512();
+	case DIGEST_SHA2_512_224:
+		return EVP_sha512_224();
+	default:
+		return EVP_sha512_256();
+	}
+}
+
+static std::vector<uint8_t> expected_digest(enum digest_alg alg, const uint8_t *data, size_t len) {
+	std::vector<uint8_t> digest(EVP_MD_get_size(digest_evp(alg)));
+	EVP_Digest(data, len, digest.data(), nullptr, digest_evp(alg), nullptr);
+	return digest;
+}
+
+class Multi_Digest_Tests : public testing::TestWithParam<int> {
+protected:
+	const std::vector<enum digest_alg>  algs = { DIGEST_MD5, DIGEST_SHA2_256, DIGEST_SHA2_512, DIGEST_SHA2_224,
+	                                             DIGEST_SHA2_384, DIGEST_SHA2_512_224, DIGEST_SHA2_512_256 };
+	std::vector<std::vector<uint8_t>> digests;
+	std::vector<uint8_t *>            outs;
+	struct hash_io_opts               opts = {};
+
+	void SetUp() override {
+		opts.flags = GetParam();
+		digests.assign(algs.size(), std::vector<uint8_t>(DIGEST_MAX_SIZE));
+		for (auto &digest : digests) outs.push_back(digest.data());
+	}
+
+	void check(const std::vector<uint8_t> &data) {
+		for (size_t i = 0; i < algs.size(); i++) {
+			digests[i].resize(digest_size(algs[i]));
+			EXPECT_EQ(digests[i], expected_digest(algs[i], data.data(), data.size())) << "algorithm " << algs[i];
+		}
+	}
+};
+
+TEST_P(Multi_Digest_Tests, bytes) {
+	for (size_t len : { (size_t) 0, (size_t) 63, (size_t) 1000, (size_t) 70000, (size_t) (1 << 20) + 17 }) {
+		auto data = rng::get_random_data(len);
+		SetUp();
+		ASSERT_TRUE(multi_digest_bytes(algs.data(), algs.size(), &opts, data.data(), data.size(), outs.data()));
+		check(data);
+	}
+}
+
+TEST_P(Multi_Digest_Tests, descriptor) {
+	auto  data = rng::get_random_data((3 << 20) + 5);
+	FILE *file = std::tmpfile();
+	ASSERT_NE(file, nullptr);
+	ASSERT_EQ(write(fileno(file), data.data(), data.size()), (ssize_t) data.size());
+
+	// Mapped, then read.
+	for (int flags : { 0, (int) HASH_IO_NO_MMAP }) {
+		opts.flags = GetParam() | flags;
+		ASSERT_EQ(lseek(fileno(file), 0, SEEK_SET), 0);
+		ASSERT_TRUE(multi_digest_descriptor(algs.data(), algs.size(), fileno(file), &opts, outs.data()));
+		check(data);
+		SetUp();
+	}
+	fclose(file);
+}
+
+INSTANTIATE_TEST_SUITE_P(multi_digest, Multi_Digest_Tests,
+                         testing::Values(0, (int) HASH_IO_THREADS, (int) HASH_IO_NO_THREADS));
+
+TEST(Multi_Digest_Tests, errors) {
+	enum digest_alg      algs[MULTI_DIGEST_MAX + 1] = {};
+	std::vector<uint8_t> digest(DIGEST_MAX_SIZE * (MULTI_DIGEST_MAX + 1));
+	uint8_t             *outs[MULTI_DIGEST_MAX + 1];
+	for (size_t i = 0; i <= MULTI_DIGEST_MAX; i++) outs[i] = digest.data() + i * DIGEST_MAX_SIZE;
+
+	EXPECT_FALSE(multi_digest_bytes(algs, MULTI_DIGEST_MAX + 1, nullptr, digest.data(), 10, outs));
+	EXPECT_TRUE(multi_digest_bytes(algs, MULTI_DIGEST_MAX, nullptr, digest.data(), 10, outs));
+	algs[1] = (enum digest_alg) 42;
+	EXPECT_FALSE(multi_digest_bytes(algs, 2, nullptr, digest.data(), 10, outs));
+	EXPECT_FALSE(multi_digest_descriptor(algs, 1, -1, nullptr, outs));
+	EXPECT_FALSE(multi_digest_file(algs, 1, "/nonexistent", nullptr, outs));
+}
+
+TEST(Digest_Tests, streaming) {
+	auto data = rng::get_random_data(5000);
+
+	for (int alg = DIGEST_MD5; alg <= DIGEST_SHA2_512_256; alg++) {
+		struct digest_ctx    ctx;
+		std::vector<uint8_t> digest(DIGEST_MAX_SIZE);
+
+		ASSERT_TRUE(digest_init(&ctx, (enum digest_alg) alg));
+		for (size_t off = 0, step = 1; off < data.size(); off += step, step = step * 2 + 1)
+			digest_update(&ctx, data.data() + off, std::min(step, data.size() - off));
+		digest.resize(ctx.digest_size);
+		digest_final_raw(&ctx, digest.data());
+		EXPECT_EQ(digest, expected_digest((enum digest_alg) alg, data.data(), data.size()));
+	}
+	EXPECT_EQ(digest_size((enum digest_alg) 42), 0u);
+}
@@ -0,0 +1,28 @@
+#include "bench.hh"
+#include "hmac.h"
+
+// Short messages signed with the same key, the case where preparing the key once pays off.
+#define MSG_SIZE 64
+
+static uint8_t secret[32];
+static uint8_t msg[MSG_SIZE];
+
+BENCH(hmac_sha2_256_64B, MSG_SIZE) {
+	uint8_t         res[32];
+	struct hmac_req req = { hmac_setup(HMAC_SHA2_256), secret, sizeof secret, msg, sizeof msg, res };
+
+	for (size_t i = 0; i < iterations; i++) hmac(req);
+	bench::do_not_optimize(res);
+	return true;
+}
+
+BENCH(hmac_key_sha2_256_64B, MSG_SIZE) {
+	uint8_t         res[32];
+	struct hmac_key key;
+
+	hmac_key_init(&key, HMAC_SHA2_256, secret, sizeof secret);
+	for (size_t i = 0; i < iterations; i++) hmac_key_mac(&key, msg, sizeof msg, res);
+	bench::do_not_optimize(res);
+	hmac_key_wipe(&key);
+	return true;
+}
@@ -6,8 +6,10 @@
  */
 
 #include "hmac.h"
+#include "common/internal.h"
 #include "crypto.h"
 #include "libft.h"
+#include <stdlib.h>
 
 /**
  * @brief Computes a block sized key ready to be used for the HMAC algorithm.
@@ -51,41 +53,186 @@ struct hmac_func hmac_setup(enum hmac_algorithm alg) {
 	return (struct hmac_func){ .H = NULL, .b = 0, .L = 0 };
 }
 
+bool hmac_sha2_alg(enum hmac_algorithm alg, enum SHA2_ALG *sha2_alg) {
+	switch (alg) {
+		case HMAC_SHA2_224:
+			*sha2_alg = SHA2_ALG_224;
+			return true;
+		case HMAC_SHA2_256:
+			*sha2_alg = SHA2_ALG_256;
+			return true;
+		case HMAC_SHA2_384:
+			*sha2_alg = SHA2_ALG_384;
+			return true;
+		case HMAC_SHA2_512:
+			*sha2_alg = SHA2_ALG_512;
+			return true;
+		case HMAC_SHA2_512_224:
+			*sha2_alg = SHA2_ALG_512_224;
+			return true;
+		case HMAC_SHA2_512_256:
+			*sha2_alg = SHA2_ALG_512_256;
+			return true;
+		default:
+			return false;
+	}
+}
+
 /**
- * @brief Get constants for the hash function.
+ * @brief Initialize the hash context of an HMAC algorithm.
  *
- * @param H The hash function we want the constants for.
- * @param b The variable to store the block size in.
- * @param L The variable to store the output size in.
+ * @return false if the algorithm is unknown.
  */
+static bool hmac_hash_init(enum hmac_algorithm alg, union hmac_hash_ctx *ctx) {
+	enum SHA2_ALG sha2_alg;
 
-uint8_t *hmac(struct hmac_req req) {
-	if (req.ctx.H == NULL || req.ctx.b == 0 || req.ctx.L == 0)// Invalid HMAC algorithm
-		return NULL;
+	if (alg == HMAC_MD5) {
+		md5_init(&ctx->md5);
+		return true;
+	}
+	return hmac_sha2_alg(alg, &sha2_alg) && sha2_init(&ctx->sha2, sha2_alg);
+}
 
-	uint8_t ipad[req.ctx.b];
-	uint8_t opad[req.ctx.b];
-	uint8_t key[req.ctx.b];// Block sized key
+static void hmac_hash_update(enum hmac_algorithm alg, union hmac_hash_ctx *ctx, const uint8_t *data, size_t len) {
+	if (alg == HMAC_MD5)
+		md5_update(&ctx->md5, data, len);
+	else
+		sha2_update(&ctx->sha2, data, len);
+}
 
-	compute_key(key, req);
+static void hmac_hash_final(enum hmac_algorithm alg, union hmac_hash_ctx *ctx, uint8_t *buf) {
+	if (alg == HMAC_MD5)
+		md5_final_raw(&ctx->md5, buf);
+	else
+		sha2_final_raw(&ctx->sha2, buf);
+}
 
-	for (size_t i = 0; i < req.ctx.b; i++) {
-		// Arbitrary values chosen by the author to split the key in two halves.
-		ipad[i] = key[i] ^ 0x36;
-		opad[i] = key[i] ^ 0x5c;
-	}
+bool hmac_key_init(struct hmac_key *key, enum hmac_algorithm alg, const uint8_t *secret, size_t secret_len) {
+	struct hmac_req req = { .ctx = hmac_setup(alg), .key = (uint8_t *) secret, .key_len = secret_len };
+	uint8_t         block_key[SHA2_MAX_BLOCK_SIZE];
+	uint8_t         pad[SHA2_MAX_BLOCK_SIZE];
 
-	{// Compute the inner hash
-		uint8_t tmp[sizeof ipad + req.message_len];
-		ft_memcpy(tmp, ipad, sizeof ipad);
-		ft_memcpy(tmp + sizeof ipad, req.message, req.message_len);
-		req.ctx.H(tmp, sizeof ipad + req.message_len, req.res_hmac);
-	}
-	{// Compute the outer hash
-		uint8_t tmp[sizeof opad + req.ctx.L];
-		ft_memcpy(tmp, opad, sizeof opad);
-		ft_memcpy(tmp + sizeof opad, req.res_hmac, req.ctx.L);
-		req.ctx.H(tmp, sizeof opad + req.ctx.L, req.res_hmac);
+	if (req.ctx.H == NULL || !hmac_hash_init(alg, &key->inner) || !hmac_hash_init(alg, &key->outer))
+		return false;
+	key->alg = alg;
+	key->L   = req.ctx.L;
+
+	compute_key(block_key, req);
+
+	// Arbitrary values chosen by the author to split the key in two halves.
+	for (size_t i = 0; i < req.ctx.b; i++) pad[i] = block_key[i] ^ 0x36;
+	hmac_hash_update(alg, &key->inner, pad, req.ctx.b);
+	for (size_t i = 0; i < req.ctx.b; i++) pad[i] = block_key[i] ^ 0x5c;
+	hmac_hash_update(alg, &key->outer, pad, req.ctx.b);
+
+	// Setting the key material to 0 to avoid leaving it on the stack.
+	ft_memset(block_key, 0, sizeof block_key);
+	ft_memset(pad, 0, sizeof pad);
+	return true;
+}
+
+void hmac_init_key(struct hmac_ctx *ctx, const struct hmac_key *key) {
+	ctx->alg   = key->alg;
+	ctx->L     = key->L;
+	ctx->inner = key->inner;
+	ctx->outer = key->outer;
+}
+
+bool hmac_init(struct hmac_ctx *ctx, enum hmac_algorithm alg, const uint8_t *key, size_t key_len) {
+	struct hmac_key hmac_key;
+
+	if (!hmac_key_init(&hmac_key, alg, key, key_len))
+		return false;
+	hmac_init_key(ctx, &hmac_key);
+	hmac_key_wipe(&hmac_key);
+	return true;
+}
+
+void hmac_update(struct hmac_ctx *ctx, const uint8_t *data, size_t len) {
+	hmac_hash_update(ctx->alg, &ctx->inner, data, len);
+}
+
+uint8_t *hmac_final(struct hmac_ctx *ctx, uint8_t *res) {
+	uint8_t inner[SHA2_MAX_DIGEST_SIZE];
+
+	hmac_hash_final(ctx->alg, &ctx->inner, inner);
+	hmac_hash_update(ctx->alg, &ctx->outer, inner, ctx->L);
+	hmac_hash_final(ctx->alg, &ctx->outer, res);
+
+	// Setting the context to 0 to avoid exposing the inner hash.
+	ft_memset(inner, 0, sizeof inner);
+	ft_memset(ctx, 0, sizeof *ctx);
+	return res;
+}
+
+uint8_t *hmac_key_mac(const struct hmac_key *key, const uint8_t *message, size_t message_len, uint8_t *res) {
+	struct hmac_ctx ctx;
+
+	hmac_init_key(&ctx, key);
+	hmac_update(&ctx, message, message_len);
+	return hmac_final(&ctx, res);
+}
+
+void hmac_key_wipe(struct hmac_key *key) {
+	ft_memset(key, 0, sizeof *key);
+}
+
+/**
+ * @brief Find the algorithm of a hash function context set up by hmac_setup.
+ *
+ * @return false if the context was not set up by hmac_setup (a hash function given by the user).
+ */
+static bool hmac_find_algorithm(struct hmac_func func, enum hmac_algorithm *alg) {
+	for (enum hmac_algorithm a = HMAC_SHA2_224; a <= HMAC_MD5; a++) {
+		struct hmac_func known = hmac_setup(a);
+
+		if (known.H == func.H && known.b == func.b && known.L == func.L) {
+			*alg = a;
+			return true;
+		}
 	}
+	return false;
+}
+
+/**
+ * @brief HMAC with a hash function only known through hmac_func, the padded key and the message are concatenated
+ * on the heap since the function hashes a single buffer.
+ */
+static uint8_t *hmac_generic(struct hmac_req req) {
+	uint8_t  key[req.ctx.b];// Block sized key
+	uint8_t *tmp = malloc(req.ctx.b + (req.message_len > req.ctx.L ? req.message_len : req.ctx.L));
+
+	if (tmp == NULL)
+		return NULL;
+	compute_key(key, req);
+
+	// Compute the inner hash
+	for (size_t i = 0; i < req.ctx.b; i++) tmp[i] = key[i] ^ 0x36;
+	ft_memcpy(tmp + req.ctx.b, req.message, req.message_len);
+	req.ctx.H(tmp, req.ctx.b + req.message_len, req.res_hmac);
+
+	// Compute the outer hash
+	for (size_t i = 0; i < req.ctx.b; i++) tmp[i] = key[i] ^ 0x5c;
+	ft_memcpy(tmp + req.ctx.b, req.res_hmac, req.ctx.L);
+	req.ctx.H(tmp, req.ctx.b + req.ctx.L, req.res_hmac);
+
+	ft_memset(key, 0, sizeof key);
+	free(tmp);
 	return req.res_hmac;
 }
+
+uint8_t *hmac(struct hmac_req req) {
+	struct hmac_ctx     ctx;
+	enum hmac_algorithm alg;
+
+	if (req.ctx.H == NULL || req.ctx.b == 0 || req.ctx.L == 0)// Invalid HMAC algorithm
+		return NULL;
+	if (!hmac_find_algorithm(req.ctx, &alg))
+		return hmac_generic(req);
+
+	// The message is hashed in place, it is never copied.
+	if (!hmac_init(&ctx, alg, req.key, req.key_len))
+		return NULL;
+	hmac_update(&ctx, req.message, req.message_len);
+	return hmac_final(&ctx, req.res_hmac);
+}
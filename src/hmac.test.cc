@@ -1,4 +1,5 @@
 #include "hmac.h"
+#include "random.hh"
 #include "test.hh"
 #include <gtest/gtest.h>
 #include <openssl/hmac.h>
@@ -44,6 +45,17 @@ static void get_hmac_actual(enum hmac_algorithm alg, const std::string &key, con
 	get_output(res, (int) req.ctx.L, hash);
 }
 
+static void get_hmac_key_actual(enum hmac_algorithm alg, const std::string &key, const std::string &msg,
+								std::string &hash) {
+	struct hmac_key hmac_key;
+	uint8_t			res[64];
+
+	ASSERT_TRUE(hmac_key_init(&hmac_key, alg, (const uint8_t *) key.c_str(), key.length()));
+	hmac_key_mac(&hmac_key, (const uint8_t *) msg.c_str(), msg.length(), res);
+	get_output(res, (int) hmac_key.L, hash);
+	hmac_key_wipe(&hmac_key);
+}
+
 class HMACTests : public testing::TestWithParam<HMACTestParams> {
 protected:
 	virtual size_t		   get_size_digest()	   = 0;
@@ -64,6 +76,9 @@ protected:
 		  get_hmac_actual(get_hmac_algorithm(), key, msg, actual);
 
 		  EXPECT_EQ(expected, actual);
+
+		  get_hmac_key_actual(get_hmac_algorithm(), key, msg, actual);
+		  EXPECT_EQ(expected, actual) << "with a prepared key";
 	}
 };
 
@@ -214,4 +229,84 @@ TEST_P(HMAC_SHA2_512_224_Tests, tests) {
 
 TEST_P(HMAC_SHA2_512_256_Tests, tests) {
 	do_test();
-}
\ No newline at end of file
+}
+
+TEST(HMAC_Key_Tests, reuse) {
+	const std::string key = "The quick brown fox jumps over the lazy dogThe quick brown fox jumps over the lazy dog";
+	struct hmac_key	  hmac_key;
+
+	ASSERT_TRUE(hmac_key_init(&hmac_key, HMAC_SHA2_512, (const uint8_t *) key.c_str(), key.length()));
+	for (size_t len : { 0, 1, 111, 112, 127, 128, 129, 1000 }) {
+		std::string msg(len, 'x');
+		std::string expected, actual;
+		uint8_t		res[64];
+
+		get_hmac(EVP_sha512, key, msg, expected, 64);
+		hmac_key_mac(&hmac_key, (const uint8_t *) msg.c_str(), msg.length(), res);
+		get_output(res, 64, actual);
+		EXPECT_EQ(expected, actual) << "len = " << len;
+	}
+	hmac_key_wipe(&hmac_key);
+}
+
+TEST(HMAC_Key_Tests, unknown_algorithm) {
+	struct hmac_key hmac_key;
+
+	EXPECT_FALSE(hmac_key_init(&hmac_key, (enum hmac_algorithm) 42, (const uint8_t *) "key", 3));
+}
+
+TEST(HMAC_Streaming_Tests, chunks) {
+	const std::vector<uint8_t> key = rng::get_random_data(100);
+	const std::vector<uint8_t> msg = rng::get_random_data(5000);
+	uint8_t					   expected[64], actual[64];
+	unsigned int			   len;
+
+	HMAC(EVP_sha384(), key.data(), (int) key.size(), msg.data(), msg.size(), expected, &len);
+	for (size_t chunk : { 1, 7, 128, 1000, 5000 }) {
+		struct hmac_ctx ctx;
+
+		ASSERT_TRUE(hmac_init(&ctx, HMAC_SHA2_384, key.data(), key.size()));
+		for (size_t i = 0; i < msg.size(); i += chunk)
+			hmac_update(&ctx, msg.data() + i, std::min(chunk, msg.size() - i));
+		ASSERT_EQ(hmac_final(&ctx, actual), actual);
+		EXPECT_EQ(std::vector<uint8_t>(actual, actual + len), std::vector<uint8_t>(expected, expected + len))
+			<< "chunk = " << chunk;
+	}
+}
+
+TEST(HMAC_Streaming_Tests, big_message) {
+	// Bigger than the default stack, the message must not be copied there.
+	std::vector<uint8_t> msg(64 << 20, 0x42);
+	uint8_t				 expected[32], actual[32];
+	struct hmac_req		 req {};
+
+	HMAC(EVP_sha256(), "key", 3, msg.data(), msg.size(), expected, nullptr);
+	req.ctx			= hmac_setup(HMAC_SHA2_256);
+	req.key			= (uint8_t *) "key";
+	req.key_len		= 3;
+	req.message		= msg.data();
+	req.message_len = msg.size();
+	req.res_hmac	= actual;
+	ASSERT_EQ(hmac(req), actual);
+	EXPECT_EQ(std::vector<uint8_t>(actual, actual + 32), std::vector<uint8_t>(expected, expected + 32));
+}
+
+static uint8_t *user_sha2_256(uint8_t *data, size_t size, uint8_t *buf) {
+	return sha2_256_bytes_raw(data, size, buf);
+}
+
+TEST(HMAC_Streaming_Tests, user_hash_function) {
+	const std::string msg = "The quick brown fox jumps over the lazy dog";
+	uint8_t			  expected[32], actual[32];
+	struct hmac_req	  req {};
+
+	HMAC(EVP_sha256(), "key", 3, (const uint8_t *) msg.c_str(), msg.length(), expected, nullptr);
+	req.ctx			= { user_sha2_256, 64, 32 };
+	req.key			= (uint8_t *) "key";
+	req.key_len		= 3;
+	req.message		= (uint8_t *) msg.c_str();
+	req.message_len = msg.length();
+	req.res_hmac	= actual;
+	ASSERT_EQ(hmac(req), actual);
+	EXPECT_EQ(std::vector<uint8_t>(actual, actual + 32), std::vector<uint8_t>(expected, expected + 32));
+}
@@ -20,12 +20,39 @@ char *md5_final(struct md5_ctx *ctx) {
 	return str;
 }
 
+/**
+ * @brief Append the padding and the length of the message (in bits, little endian) then compress the last block(s).
+ *
+ * @param ctx The context to pad.
+ */
+static void md5_pad(struct md5_ctx *ctx) {
+	ctx->blk[ctx->blk_len++] = 0x80;// 0b10000000 (first bit after the last byte of data is always set to 1)
+	if (ctx->blk_len > MD5_BLK_LEN - MD5_SIZE_LAST) {
+		ft_memset(ctx->blk + ctx->blk_len, 0, MD5_BLK_LEN - ctx->blk_len);
+		md5_compress(ctx, ctx->blk, 1);
+		ctx->blk_len = 0;
+	}
+	ft_memset(ctx->blk + ctx->blk_len, 0, MD5_BLK_LEN - ctx->blk_len);
+
+	uint64_t bits = ctx->len << 3;
+	for (size_t i = 0; i < MD5_SIZE_LAST; i++, bits >>= 8) ctx->blk[MD5_BLK_LEN - MD5_SIZE_LAST + i] = (uint8_t) bits;
+	md5_compress(ctx, ctx->blk, 1);
+}
+
+void md5_store_digest(const struct md5_ctx *ctx, uint8_t *buf) {
+	// The digest is the state as little endian words.
+	uint32_t state[4] = { ctx->a, ctx->b, ctx->c, ctx->d };
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	for (size_t i = 0; i < 4; i++) state[i] = bswap_32(state[i]);
+#endif
+	ft_memcpy(buf, state, sizeof state);
+}
+
 uint8_t *md5_final_raw(struct md5_ctx *ctx, uint8_t *output) {
-	uint32_t *output_32 = (uint32_t *) output;
-	output_32[0]        = ctx->a;
-	output_32[1]        = ctx->b;
-	output_32[2]        = ctx->c;
-	output_32[3]        = ctx->d;
+	md5_pad(ctx);
+	md5_store_digest(ctx, output);
 
+	// Setting the context to 0 to avoid exposing the internal state of the context.
+	ft_memset(ctx, 0, sizeof *ctx);
 	return output;
 }
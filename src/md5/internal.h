@@ -9,9 +9,20 @@
 #define MD5_INTERNAL_H
 
 #include "common.h"
+#include "common/internal.h"
 #include "crypto.h"
 #include <stdlib.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The multi-buffer kernels (SSE2, AVX2 and AVX-512) are compiled in on x86-64, they are only used if the CPU supports
+// them. They need __builtin_shufflevector (clang, or gcc 12 and later).
+#if defined(__x86_64__) && (defined(__clang__) || __GNUC__ >= 12)
+#	define MD5_HAVE_LANES
+#endif
+
 #undef F
 #undef G
 #undef H
@@ -29,63 +40,123 @@
 #define I(B, C, D) (C ^ (B | ~D))
 
 #define MD5_HASH_SIZE 16 * 2 + 1
-#define MD5_BLK_LEN 1 << 6
+#define MD5_BLK_LEN MD5_BLOCK_SIZE
 #define MD5_SIZE_LAST 8
-#define MD5_DIGEST_SIZE 16
 
 /**
- * @brief Structure used to store the md5 context.
+ * @brief The 64 steps of RFC 1321, as STEP(f, a, b, c, d, i, k, s): the round function f, the index i of the
+ * word of the block, the sine constant k and the shift s. The variables are rotated instead of being moved around.
  */
-struct md5_ctx {
-	uint32_t        a, b, c, d;///< Current state
+#define MD5_STEPS(STEP)                                                                                                \
+	STEP(F, a, b, c, d, 0, 0xd76aa478, 7);                                                                             \
+	STEP(F, d, a, b, c, 1, 0xe8c7b756, 12);                                                                            \
+	STEP(F, c, d, a, b, 2, 0x242070db, 17);                                                                            \
+	STEP(F, b, c, d, a, 3, 0xc1bdceee, 22);                                                                            \
+	STEP(F, a, b, c, d, 4, 0xf57c0faf, 7);                                                                             \
+	STEP(F, d, a, b, c, 5, 0x4787c62a, 12);                                                                            \
+	STEP(F, c, d, a, b, 6, 0xa8304613, 17);                                                                            \
+	STEP(F, b, c, d, a, 7, 0xfd469501, 22);                                                                            \
+	STEP(F, a, b, c, d, 8, 0x698098d8, 7);                                                                             \
+	STEP(F, d, a, b, c, 9, 0x8b44f7af, 12);                                                                            \
+	STEP(F, c, d, a, b, 10, 0xffff5bb1, 17);                                                                           \
+	STEP(F, b, c, d, a, 11, 0x895cd7be, 22);                                                                           \
+	STEP(F, a, b, c, d, 12, 0x6b901122, 7);                                                                            \
+	STEP(F, d, a, b, c, 13, 0xfd987193, 12);                                                                           \
+	STEP(F, c, d, a, b, 14, 0xa679438e, 17);                                                                           \
+	STEP(F, b, c, d, a, 15, 0x49b40821, 22);                                                                           \
+                                                                                                                       \
+	STEP(G, a, b, c, d, 1, 0xf61e2562, 5);                                                                             \
+	STEP(G, d, a, b, c, 6, 0xc040b340, 9);                                                                             \
+	STEP(G, c, d, a, b, 11, 0x265e5a51, 14);                                                                           \
+	STEP(G, b, c, d, a, 0, 0xe9b6c7aa, 20);                                                                            \
+	STEP(G, a, b, c, d, 5, 0xd62f105d, 5);                                                                             \
+	STEP(G, d, a, b, c, 10, 0x02441453, 9);                                                                            \
+	STEP(G, c, d, a, b, 15, 0xd8a1e681, 14);                                                                           \
+	STEP(G, b, c, d, a, 4, 0xe7d3fbc8, 20);                                                                            \
+	STEP(G, a, b, c, d, 9, 0x21e1cde6, 5);                                                                             \
+	STEP(G, d, a, b, c, 14, 0xc33707d6, 9);                                                                            \
+	STEP(G, c, d, a, b, 3, 0xf4d50d87, 14);                                                                            \
+	STEP(G, b, c, d, a, 8, 0x455a14ed, 20);                                                                            \
+	STEP(G, a, b, c, d, 13, 0xa9e3e905, 5);                                                                            \
+	STEP(G, d, a, b, c, 2, 0xfcefa3f8, 9);                                                                             \
+	STEP(G, c, d, a, b, 7, 0x676f02d9, 14);                                                                            \
+	STEP(G, b, c, d, a, 12, 0x8d2a4c8a, 20);                                                                           \
+                                                                                                                       \
+	STEP(H, a, b, c, d, 5, 0xfffa3942, 4);                                                                             \
+	STEP(H, d, a, b, c, 8, 0x8771f681, 11);                                                                            \
+	STEP(H, c, d, a, b, 11, 0x6d9d6122, 16);                                                                           \
+	STEP(H, b, c, d, a, 14, 0xfde5380c, 23);                                                                           \
+	STEP(H, a, b, c, d, 1, 0xa4beea44, 4);                                                                             \
+	STEP(H, d, a, b, c, 4, 0x4bdecfa9, 11);                                                                            \
+	STEP(H, c, d, a, b, 7, 0xf6bb4b60, 16);                                                                            \
+	STEP(H, b, c, d, a, 10, 0xbebfbc70, 23);                                                                           \
+	STEP(H, a, b, c, d, 13, 0x289b7ec6, 4);                                                                            \
+	STEP(H, d, a, b, c, 0, 0xeaa127fa, 11);                                                                            \
+	STEP(H, c, d, a, b, 3, 0xd4ef3085, 16);                                                                            \
+	STEP(H, b, c, d, a, 6, 0x04881d05, 23);                                                                            \
+	STEP(H, a, b, c, d, 9, 0xd9d4d039, 4);                                                                             \
+	STEP(H, d, a, b, c, 12, 0xe6db99e5, 11);                                                                           \
+	STEP(H, c, d, a, b, 15, 0x1fa27cf8, 16);                                                                           \
+	STEP(H, b, c, d, a, 2, 0xc4ac5665, 23);                                                                            \
+                                                                                                                       \
+	STEP(I, a, b, c, d, 0, 0xf4292244, 6);                                                                             \
+	STEP(I, d, a, b, c, 7, 0x432aff97, 10);                                                                            \
+	STEP(I, c, d, a, b, 14, 0xab9423a7, 15);                                                                           \
+	STEP(I, b, c, d, a, 5, 0xfc93a039, 21);                                                                            \
+	STEP(I, a, b, c, d, 12, 0x655b59c3, 6);                                                                            \
+	STEP(I, d, a, b, c, 3, 0x8f0ccc92, 10);                                                                            \
+	STEP(I, c, d, a, b, 10, 0xffeff47d, 15);                                                                           \
+	STEP(I, b, c, d, a, 1, 0x85845dd1, 21);                                                                            \
+	STEP(I, a, b, c, d, 8, 0x6fa87e4f, 6);                                                                             \
+	STEP(I, d, a, b, c, 15, 0xfe2ce6e0, 10);                                                                           \
+	STEP(I, c, d, a, b, 6, 0xa3014314, 15);                                                                            \
+	STEP(I, b, c, d, a, 13, 0x4e0811a1, 21);                                                                           \
+	STEP(I, a, b, c, d, 4, 0xf7537e82, 6);                                                                             \
+	STEP(I, d, a, b, c, 11, 0xbd3af235, 10);                                                                           \
+	STEP(I, c, d, a, b, 2, 0x2ad7d2bb, 15);                                                                            \
+	STEP(I, b, c, d, a, 9, 0xeb86d391, 21)
 
-	///< These values point to static variables in the init.c
-	///< @see init.c
-	const uint32_t *buf;  ///< Precomputed constants (for speed up, formula: floor(abs(sin(i + 1)) * 2**32))
-	const uint8_t  *shift;///< Shift amounts
+/**
+ * @brief Describes a multi-buffer kernel.
+ */
+struct md5_lanes {
+	size_t     nb;      ///< Number of lanes.
+	lanes_func compress;///< Compression function.
 };
 
+#ifdef MD5_HAVE_LANES
+void     md5_compress_x4(void *state, const uint8_t *const *blks) __visibility_internal; ///< SSE2
+void     md5_compress_x8(void *state, const uint8_t *const *blks) __visibility_internal; ///< AVX2
+void     md5_compress_x16(void *state, const uint8_t *const *blks) __visibility_internal;///< AVX-512F
+#endif
 
 /**
- * @brief Initialize the MD5 context with all the values given by the RFC 1321.
- * @param ctx The context to initialize.
- *
- * @see https://tools.ietf.org/html/rfc1321
+ * @brief Select the best multi-buffer kernel on this CPU.
  *
- * @warning This function is internal and should not be called by the user.
- * @warning This function must be called before any operation related to md5.
+ * @return The kernel, or NULL if there is none.
  */
-void     md5_init(struct md5_ctx *ctx) __visibility_internal;
+const struct md5_lanes *md5_select_lanes(void) __visibility_internal;
 
 /**
- * @brief Updates the md5 context with the given data.
+ * @brief Hash several messages with the given multi-buffer kernel.
  *
- * @param ctx The context to update.
- * @param input The data to update the context with.
+ * Each lane of the kernel hashes one message, a lane is refilled with the next message as soon as its message is
+ * done. Once there are not enough messages left to keep half of the lanes busy, the remaining ones are finished
+ * with the single buffer compression function.
  *
- * @warning This function is internal and should not be called by the user.
- * @warning This function must be called after exactly one call to md5_init.
+ * @param lanes The kernel to use.
+ * @param msgs The messages.
+ * @param lens The length of each message.
+ * @param n The number of messages.
+ * @param out The buffer to store the digests in (n digests stored one after the other).
  *
- * @see md5_init
+ * @return The given buffer.
  */
-void     md5_update(struct md5_ctx *ctx, const uint8_t *input) __visibility_internal;
+uint8_t *md5_many_lanes(const struct md5_lanes *lanes, const uint8_t *const *msgs, const size_t *lens, size_t n,
+                        uint8_t *out) __visibility_internal;
 
-/**
- * @brief Generates the final hash from the md5 context.
- * @param ctx The context to generate the hash from.
- *
- * @warning This function is internal and should not be called by the user.
- * @note This function will flush the context after generating the hash.
- */
-char    *md5_final(struct md5_ctx *ctx) __visibility_internal;
-
-/**
- * @brief Generates the final hash from the md5 context and uses the given buffer to store the hash.
- *
- * @param ctx The context to generate the hash from.
- * @param output The buffer to store the hash in.
- * @return The buffer containing the hash.
- */
-uint8_t *md5_final_raw(struct md5_ctx *ctx, uint8_t *output) __visibility_internal;
+#ifdef __cplusplus
+}
+#endif
 
 #endif
@@ -0,0 +1,54 @@
+/**
+ * @file lanes.c
+ * @author Ghali Boucetta (gboucett@student.42.fr)
+ * @brief MD5 compression functions working on several independent messages at once.
+ * @date 2026-10-17
+ *
+ * Each vector holds the same word of the state of several messages (one message per lane), so the steps are computed
+ * for all the lanes with the same instructions. The kernels are written with the GCC vector extensions and compiled
+ * for the instruction set they target, the scheduling of the messages is done in many.c.
+ */
+
+#include "internal.h"
+
+#ifdef MD5_HAVE_LANES
+
+// The kernels use __builtin_memcpy instead of ft_memcpy so that the unaligned vector loads are inlined.
+
+// ROTL from common.h relies on sizeof, which is the size of the whole vector here.
+#	define VROTL32(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+
+// The words of the blocks are little endian, like x86-64, they are loaded as is.
+#	define VLE32(x) (x)
+
+// One step for all the lanes, the round functions of internal.h only use bitwise operators and work on vectors.
+#	define VSTEP(f, a, b, c, d, i, k, s)                                                                               \
+		{                                                                                                              \
+			a += f(b, c, d) + x[i] + (k);                                                                              \
+			a  = VROTL32(a, s) + b;                                                                                    \
+		}
+
+/**
+ * @brief Defines an MD5 compression function for a given number of lanes.
+ *
+ * The state is stored word by word: state[i * lanes + l] is the word i of the lane l.
+ */
+#	define DEFINE_MD5_LANES(name, isa, vtype, lanes)                                                                   \
+		__attribute__((target(isa))) void name(void *state, const uint8_t *const *blks) {                              \
+			vtype s[4], x[16];                                                                                         \
+			vtype a, b, c, d;                                                                                          \
+                                                                                                                       \
+			__builtin_memcpy(s, state, sizeof s);                                                                      \
+			VLOAD_BLOCKS(vtype, lanes, x, VLE32);                                                                      \
+                                                                                                                       \
+			a = s[0], b = s[1], c = s[2], d = s[3];                                                                    \
+			MD5_STEPS(VSTEP);                                                                                          \
+			s[0] += a, s[1] += b, s[2] += c, s[3] += d;                                                                \
+			__builtin_memcpy(state, s, sizeof s);                                                                      \
+		}
+
+DEFINE_MD5_LANES(md5_compress_x4, "sse2", v4u32, 4)
+DEFINE_MD5_LANES(md5_compress_x8, "avx2", v8u32, 8)
+DEFINE_MD5_LANES(md5_compress_x16, "avx512f", v16u32, 16)
+
+#endif
@@ -0,0 +1,66 @@
+/**
+ * @file many.c
+ * @author Ghali Boucetta (gboucett@student.42.fr)
+ * @brief Multi-buffer MD5: hash a batch of independent messages with the SIMD kernels of lanes.c.
+ * @date 2026-10-17
+ */
+
+#include "internal.h"
+#include "libft.h"
+
+/**
+ * @brief Single buffer compression function on a bare chaining state, for the leftovers of the lane scheduler.
+ */
+static void md5_compress_state(void *state, const uint8_t *blks, size_t nb) {
+	uint32_t      *words = state;
+	struct md5_ctx ctx   = { .a = words[0], .b = words[1], .c = words[2], .d = words[3] };
+
+	md5_compress(&ctx, blks, nb);
+	words[0] = ctx.a, words[1] = ctx.b, words[2] = ctx.c, words[3] = ctx.d;
+}
+
+uint8_t *md5_many_lanes(const struct md5_lanes *lanes, const uint8_t *const *msgs, const size_t *lens, size_t n,
+                        uint8_t *out) {
+	struct md5_ctx ctx;
+
+	md5_init(&ctx);
+
+	const uint32_t          iv[4] = { ctx.a, ctx.b, ctx.c, ctx.d };
+	const struct lanes_hash hash  = {
+		.block_size  = MD5_BLOCK_SIZE,
+		.len_size    = MD5_SIZE_LAST,
+		.big_endian  = false,
+		.word_size   = sizeof *iv,
+		.nb_words    = 4,
+		.digest_size = MD5_DIGEST_SIZE,
+		.iv          = iv,
+		.compress    = md5_compress_state,
+	};
+	return lanes_hash_many(&hash, lanes->nb, lanes->compress, msgs, lens, n, out);
+}
+
+const struct md5_lanes *md5_select_lanes(void) {
+#ifdef MD5_HAVE_LANES
+	static const struct md5_lanes md5_x16 = { .nb = 16, .compress = md5_compress_x16 };
+	static const struct md5_lanes md5_x8  = { .nb = 8, .compress = md5_compress_x8 };
+	static const struct md5_lanes md5_x4  = { .nb = 4, .compress = md5_compress_x4 };
+
+	if (cpu_has(CPU_FEATURE_AVX512F))
+		return &md5_x16;
+	if (cpu_has(CPU_FEATURE_AVX2))
+		return &md5_x8;
+	if (cpu_has(CPU_FEATURE_SSE2))
+		return &md5_x4;
+#endif
+	return NULL;
+}
+
+uint8_t *md5_many(const uint8_t *const *msgs, const size_t *lens, size_t n, uint8_t *out) {
+	const struct md5_lanes *lanes = md5_select_lanes();
+
+	if (lanes)
+		return md5_many_lanes(lanes, msgs, lens, n, out);
+
+	for (size_t i = 0; i < n; i++) md5_bytes_raw(msgs[i], lens[i], out + i * MD5_DIGEST_SIZE);
+	return out;
+}
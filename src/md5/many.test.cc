@@ -0,0 +1,89 @@
+#include "common.h"
+#include "crypto.h"
+#include "internal.h"
+#include "random.hh"
+#include <gtest/gtest.h>
+#include <openssl/evp.h>
+#include <vector>
+
+class MD5_Many_Tests : public testing::Test {
+protected:
+	std::vector<std::vector<uint8_t>> msgs;
+	std::vector<const uint8_t *>      ptrs;
+	std::vector<size_t>               lens;
+	std::vector<uint8_t>              expected;
+
+	// Batch mixing empty messages, lengths around the padding limits and a few long messages.
+	void make_batch(size_t n) {
+		std::uniform_int_distribution<size_t> short_len(0, 300), long_len(1000, 20000);
+
+		for (size_t i = 0; i < n; i++) {
+			size_t len = (i % 11 == 0) ? long_len(rng::engine) : (i < 20 ? i * 7 : short_len(rng::engine));
+			msgs.push_back(rng::get_random_data(len));
+		}
+		for (auto &msg : msgs) {
+			ptrs.push_back(msg.data());
+			lens.push_back(msg.size());
+		}
+
+		expected.resize(n * MD5_DIGEST_SIZE);
+		for (size_t i = 0; i < n; i++)
+			EVP_Digest(msgs[i].data(), msgs[i].size(), expected.data() + i * MD5_DIGEST_SIZE, nullptr, EVP_md5(),
+			           nullptr);
+	}
+
+	void check(const struct md5_lanes *lanes) {
+		for (size_t n : { 0, 1, 3, 4, 5, 8, 9, 16, 17, 100 }) {
+			msgs.clear();
+			ptrs.clear();
+			lens.clear();
+			make_batch(n);
+
+			std::vector<uint8_t> out(n * MD5_DIGEST_SIZE);
+			uint8_t             *ret;
+			if (lanes)
+				ret = md5_many_lanes(lanes, ptrs.data(), lens.data(), n, out.data());
+			else
+				ret = md5_many(ptrs.data(), lens.data(), n, out.data());
+			ASSERT_EQ(ret, out.data());
+			EXPECT_EQ(out, expected) << "n = " << n;
+		}
+	}
+};
+
+TEST_F(MD5_Many_Tests, dispatched) {
+	check(nullptr);
+}
+
+TEST_F(MD5_Many_Tests, sse2) {
+#ifdef MD5_HAVE_LANES
+	if (!cpu_has(CPU_FEATURE_SSE2))
+		GTEST_SKIP() << "SSE2 not supported by this CPU";
+	struct md5_lanes lanes = { 4, md5_compress_x4 };
+	check(&lanes);
+#else
+	GTEST_SKIP() << "Multi-buffer kernels not compiled in";
+#endif
+}
+
+TEST_F(MD5_Many_Tests, avx2) {
+#ifdef MD5_HAVE_LANES
+	if (!cpu_has(CPU_FEATURE_AVX2))
+		GTEST_SKIP() << "AVX2 not supported by this CPU";
+	struct md5_lanes lanes = { 8, md5_compress_x8 };
+	check(&lanes);
+#else
+	GTEST_SKIP() << "Multi-buffer kernels not compiled in";
+#endif
+}
+
+TEST_F(MD5_Many_Tests, avx512) {
+#ifdef MD5_HAVE_LANES
+	if (!cpu_has(CPU_FEATURE_AVX512F))
+		GTEST_SKIP() << "AVX-512 not supported by this CPU";
+	struct md5_lanes lanes = { 16, md5_compress_x16 };
+	check(&lanes);
+#else
+	GTEST_SKIP() << "Multi-buffer kernels not compiled in";
+#endif
+}
@@ -0,0 +1,146 @@
+#include "bench.hh"
+#include "crypto.h"
+#include "internal.h"
+#include <cstring>
+#include <openssl/evp.h>
+#include <vector>
+
+#define NB_BLOCKS 1024
+
+// Rolled compression function (a loop over the steps picking the round function and the word index, with the sines
+// and shifts read from tables), kept here to compare it to the unrolled one.
+static const uint32_t sines[64] = {
+	0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+	0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+	0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+	0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+	0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+	0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+	0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+	0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391,
+};
+
+static const uint8_t shifts[64] = {
+	7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22, 5, 9, 14, 20, 5, 9, 14, 20, 5, 9, 14, 20, 5, 9, 14, 20,
+	4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21,
+};
+
+static void md5_compress_rolled(uint32_t *state, const uint8_t *blks, size_t nb) {
+	for (size_t n = 0; n < nb; n++, blks += MD5_BLOCK_SIZE) {
+		uint32_t data[16], a = state[0], b = state[1], c = state[2], d = state[3];
+
+		memcpy(data, blks, sizeof data);
+		for (int i = 0; i < 64; i++) {
+			uint32_t f, g;
+
+			if (i < 16)
+				f = F(b, c, d), g = i;
+			else if (i < 32)
+				f = G(b, c, d), g = (5 * i + 1) % 16;
+			else if (i < 48)
+				f = H(b, c, d), g = (3 * i + 5) % 16;
+			else
+				f = I(b, c, d), g = (7 * i) % 16;
+
+			f += a + sines[i] + data[g];
+			a  = d;
+			d  = c;
+			c  = b;
+			b += ROTL(f, shifts[i]);
+		}
+
+		state[0] += a, state[1] += b, state[2] += c, state[3] += d;
+	}
+}
+
+static const std::vector<uint8_t> data(NB_BLOCKS * MD5_BLOCK_SIZE + 1, 0x42);
+
+BENCH(md5_compress_rolled, NB_BLOCKS * MD5_BLOCK_SIZE) {
+	uint32_t state[4] = {};
+
+	for (size_t i = 0; i < iterations; i++) md5_compress_rolled(state, data.data(), NB_BLOCKS);
+	bench::do_not_optimize(state);
+	return true;
+}
+
+BENCH(md5_compress_unrolled, NB_BLOCKS * MD5_BLOCK_SIZE) {
+	struct md5_ctx ctx;
+
+	md5_init(&ctx);
+	for (size_t i = 0; i < iterations; i++) md5_compress(&ctx, data.data(), NB_BLOCKS);
+	bench::do_not_optimize(ctx);
+	return true;
+}
+
+BENCH(md5_compress_unaligned, NB_BLOCKS * MD5_BLOCK_SIZE) {
+	struct md5_ctx ctx;
+
+	md5_init(&ctx);
+	for (size_t i = 0; i < iterations; i++) md5_compress(&ctx, data.data() + 1, NB_BLOCKS);
+	bench::do_not_optimize(ctx);
+	return true;
+}
+
+BENCH(md5_bytes_64KiB, NB_BLOCKS * MD5_BLOCK_SIZE) {
+	uint8_t out[MD5_DIGEST_SIZE];
+
+	for (size_t i = 0; i < iterations; i++) md5_bytes_raw(data.data(), NB_BLOCKS * MD5_BLOCK_SIZE, out);
+	bench::do_not_optimize(out);
+	return true;
+}
+
+// The reference: the unrolled MD5 should stay within 10% of it.
+BENCH(md5_openssl_64KiB, NB_BLOCKS * MD5_BLOCK_SIZE) {
+	uint8_t out[MD5_DIGEST_SIZE];
+
+	for (size_t i = 0; i < iterations; i++)
+		EVP_Digest(data.data(), NB_BLOCKS * MD5_BLOCK_SIZE, out, nullptr, EVP_md5(), nullptr);
+	bench::do_not_optimize(out);
+	return true;
+}
+
+// Batch of short messages, as when checking the ETags of many small objects.
+#define NB_MSGS 256
+#define MSG_SIZE 1000
+
+static const std::vector<uint8_t> msgs(NB_MSGS * MSG_SIZE, 0x42);
+
+BENCH(md5_bytes_batch, NB_MSGS * MSG_SIZE) {
+	std::vector<uint8_t> out(NB_MSGS * MD5_DIGEST_SIZE);
+
+	for (size_t i = 0; i < iterations; i++)
+		for (size_t m = 0; m < NB_MSGS; m++)
+			md5_bytes_raw(msgs.data() + m * MSG_SIZE, MSG_SIZE, out.data() + m * MD5_DIGEST_SIZE);
+	bench::do_not_optimize(out);
+	return true;
+}
+
+static bool md5_many_bench(const struct md5_lanes *lanes, size_t iterations) {
+	std::vector<uint8_t>         out(NB_MSGS * MD5_DIGEST_SIZE);
+	std::vector<const uint8_t *> ptrs(NB_MSGS);
+	std::vector<size_t>          lens(NB_MSGS, MSG_SIZE);
+
+	if (!lanes)
+		return false;
+	for (size_t m = 0; m < NB_MSGS; m++) ptrs[m] = msgs.data() + m * MSG_SIZE;
+	for (size_t i = 0; i < iterations; i++) md5_many_lanes(lanes, ptrs.data(), lens.data(), NB_MSGS, out.data());
+	bench::do_not_optimize(out);
+	return true;
+}
+
+#ifdef MD5_HAVE_LANES
+BENCH(md5_many_sse2, NB_MSGS * MSG_SIZE) {
+	const struct md5_lanes lanes = { 4, md5_compress_x4 };
+	return cpu_has(CPU_FEATURE_SSE2) && md5_many_bench(&lanes, iterations);
+}
+
+BENCH(md5_many_avx2, NB_MSGS * MSG_SIZE) {
+	const struct md5_lanes lanes = { 8, md5_compress_x8 };
+	return cpu_has(CPU_FEATURE_AVX2) && md5_many_bench(&lanes, iterations);
+}
+
+BENCH(md5_many_avx512, NB_MSGS * MSG_SIZE) {
+	const struct md5_lanes lanes = { 16, md5_compress_x16 };
+	return cpu_has(CPU_FEATURE_AVX512F) && md5_many_bench(&lanes, iterations);
+}
+#endif
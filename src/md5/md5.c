@@ -9,30 +9,11 @@
 #include <unistd.h>
 #include <string.h>
 
-static bool __intermediate_md5_bytes(const struct msg *msg, struct md5_ctx *ctx) {
-	struct blk *blks = get_blocks(msg, MD5_BLK_LEN, MD5_SIZE_LAST, true);
-	if (blks == NULL)
-		return false;
-
-	size_t nb = blks->len / (MD5_BLK_LEN);
-	for (size_t i = 0; i < nb; i++) md5_update(ctx, blks->data + (i * MD5_BLK_LEN));
-
-	free(blks->data);
-	free(blks);
-	return true;
-}
-
 uint8_t *md5_bytes_raw(const uint8_t *bytes, size_t len, uint8_t *output) {
 	struct md5_ctx ctx;
-	struct msg     msg = { .data = bytes, .len = len, .is_last_part = true, .filesize = len };
 
 	md5_init(&ctx);
-
-	if (!__intermediate_md5_bytes(&msg, &ctx)) {
-		ft_memset(&ctx, 0, sizeof ctx);
-		return NULL;
-	}
-
+	md5_update(&ctx, bytes, len);
 	return md5_final_raw(&ctx, output);
 }
 
@@ -53,52 +34,29 @@ char *md5(const char *str) {
 	return md5_bytes(bytes, len);
 }
 
-uint8_t *md5_descriptor_raw(int fd, uint8_t *output) {
+static void md5_update_descriptor(void *ctx, const uint8_t *data, size_t len) {
+	md5_update(ctx, data, len);
+}
+
+uint8_t *md5_descriptor_opts_raw(int fd, const struct hash_io_opts *opts, uint8_t *output) {
 	struct md5_ctx ctx;
 
 	md5_init(&ctx);
-
-	uint8_t    buffer[4096];
-	struct msg msg;
-
-	msg.is_last_part      = false;
-
-	bool        done_last = false;
-	ssize_t     ret;
-	__uint128_t filesize = 0;
-	for (ret = 0; (ret = read(fd, buffer, sizeof buffer)) > 0;) {
-		msg.data = buffer;
-		msg.len  = ret;
-		filesize += ret;
-
-		if (ret < (ssize_t) sizeof buffer) {
-			msg.filesize     = filesize;
-			msg.is_last_part = true;
-			done_last        = true;
-		}
-
-		if (!__intermediate_md5_bytes(&msg, &ctx)) {
-			ft_memset(&ctx, 0, sizeof(ctx));
-			return NULL;
-		}
-	}
-	if (!done_last) {
-		msg.filesize     = filesize;
-		msg.is_last_part = true;
-
-		msg.data         = (unsigned char *) "";
-		msg.len          = 0;
-		if (!__intermediate_md5_bytes(&msg, &ctx)) {
-			ft_memset(&ctx, 0, sizeof(ctx));
-			return NULL;
-		}
+	if (!hash_descriptor(fd, opts, md5_update_descriptor, &ctx)) {
+		ft_memset(&ctx, 0, sizeof(ctx));
+		return NULL;
 	}
 	return md5_final_raw(&ctx, output);
 }
 
+uint8_t *md5_descriptor_raw(int fd, uint8_t *output) {
+	return md5_descriptor_opts_raw(fd, NULL, output);
+}
+
 char *md5_descriptor(int fd) {
 	uint8_t buf[MD5_DIGEST_SIZE];
-	md5_descriptor_raw(fd, buf);
+	if (!md5_descriptor_raw(fd, buf))
+		return NULL;
 	return stringify_hash(buf, MD5_DIGEST_SIZE);
 }
 
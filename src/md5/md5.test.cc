@@ -1,5 +1,6 @@
 #include "crypto.h"
 #include "digest.hh"
+#include "random.hh"
 
 class MD5_Tests : public DigestTests {
 public:
@@ -24,4 +25,31 @@ INSTANTIATE_TEST_SUITE_P(string_tests, MD5_Tests, testing::ValuesIn(range_files)
 
 TEST_P(MD5_Tests, tests) {
 	run_test();
-}
\ No newline at end of file
+}
+TEST(MD5_Streaming_Tests, resume) {
+	for (size_t size : { 0, 1, 55, 56, 63, 64, 65, 1000 }) {
+		std::vector<uint8_t> msg(size + 100);
+		std::generate(msg.begin(), msg.end(), [] { return static_cast<uint8_t>(rng::engine()); });
+
+		// Export after size bytes, then resume in a context holding garbage.
+		struct md5_ctx ctx;
+		uint8_t        midstate[MD5_MIDSTATE_SIZE];
+		md5_init(&ctx);
+		md5_update(&ctx, msg.data(), size);
+		md5_export(&ctx, midstate);
+		memset(&ctx, 0xa5, sizeof ctx);
+
+		ASSERT_TRUE(md5_import(&ctx, midstate));
+		md5_update(&ctx, msg.data() + size, msg.size() - size);
+		std::vector<uint8_t> actual(MD5_DIGEST_SIZE), expected(MD5_DIGEST_SIZE);
+		md5_final_raw(&ctx, actual.data());
+		EVP_Digest(msg.data(), msg.size(), expected.data(), nullptr, EVP_md5(), nullptr);
+		EXPECT_EQ(actual, expected) << "size: " << size;
+	}
+
+	uint8_t        sha2_midstate[SHA2_MIDSTATE_SIZE];
+	struct sha2    sha2_ctx;
+	struct md5_ctx ctx;
+	sha2_init(&sha2_ctx, SHA2_ALG_256);
+	EXPECT_FALSE(md5_import(&ctx, sha2_export(&sha2_ctx, sha2_midstate)));
+}
@@ -0,0 +1,60 @@
+/**
+ * @file midstate.c
+ * @author Ghali Boucetta (gboucett@student.42.fr)
+ * @brief Export and import of the state of an MD5 context, to resume a hash in another process.
+ * @date 2026-10-17
+ */
+
+#include "internal.h"
+#include "libft.h"
+
+#define MD5_MIDSTATE_MAGIC 0x4d ///< First byte of an exported MD5 state ('M').
+#define MD5_MIDSTATE_FORMAT 1   ///< Version of the layout below.
+
+// Layout of an exported state (offsets in bytes), every integer is big endian.
+#define MD5_MIDSTATE_OFF_LEN 2   ///< Number of bytes fed to the context (64 bits).
+#define MD5_MIDSTATE_OFF_STATE 10///< The chaining state (a, b, c then d, 32 bits each).
+#define MD5_MIDSTATE_OFF_BLK 26  ///< The pending bytes, followed by zeros up to MD5_BLOCK_SIZE.
+
+_Static_assert(MD5_MIDSTATE_OFF_BLK + MD5_BLOCK_SIZE == MD5_MIDSTATE_SIZE, "wrong MD5_MIDSTATE_SIZE");
+
+static void store_be(uint8_t *out, uint64_t value, size_t size) {
+	for (size_t i = size; i--; value >>= 8) out[i] = (uint8_t) value;
+}
+
+static uint64_t load_be(const uint8_t *in, size_t size) {
+	uint64_t value = 0;
+
+	for (size_t i = 0; i < size; i++) value = value << 8 | in[i];
+	return value;
+}
+
+uint8_t *md5_export(const struct md5_ctx *ctx, uint8_t *buf) {
+	ft_memset(buf, 0, MD5_MIDSTATE_SIZE);
+	buf[0] = MD5_MIDSTATE_MAGIC;
+	buf[1] = MD5_MIDSTATE_FORMAT;
+	store_be(buf + MD5_MIDSTATE_OFF_LEN, ctx->len, 8);
+	store_be(buf + MD5_MIDSTATE_OFF_STATE, ctx->a, 4);
+	store_be(buf + MD5_MIDSTATE_OFF_STATE + 4, ctx->b, 4);
+	store_be(buf + MD5_MIDSTATE_OFF_STATE + 8, ctx->c, 4);
+	store_be(buf + MD5_MIDSTATE_OFF_STATE + 12, ctx->d, 4);
+	ft_memcpy(buf + MD5_MIDSTATE_OFF_BLK, ctx->blk, ctx->blk_len);
+	return buf;
+}
+
+bool md5_import(struct md5_ctx *ctx, const uint8_t *buf) {
+	if (buf[0] != MD5_MIDSTATE_MAGIC || buf[1] != MD5_MIDSTATE_FORMAT)
+		return false;
+
+	md5_init(ctx);
+	ctx->a = (uint32_t) load_be(buf + MD5_MIDSTATE_OFF_STATE, 4);
+	ctx->b = (uint32_t) load_be(buf + MD5_MIDSTATE_OFF_STATE + 4, 4);
+	ctx->c = (uint32_t) load_be(buf + MD5_MIDSTATE_OFF_STATE + 8, 4);
+	ctx->d = (uint32_t) load_be(buf + MD5_MIDSTATE_OFF_STATE + 12, 4);
+
+	// The pending bytes are the end of the message, after its last full block.
+	ctx->len     = load_be(buf + MD5_MIDSTATE_OFF_LEN, 8);
+	ctx->blk_len = ctx->len % MD5_BLOCK_SIZE;
+	ft_memcpy(ctx->blk, buf + MD5_MIDSTATE_OFF_BLK, ctx->blk_len);
+	return true;
+}
@@ -8,61 +8,64 @@
  */
 
 #include "internal.h"
+#include "libft.h"
 
-#define ROUND1(a, b, c, d, f, g, i)                                                                                    \
+// One step with the round function f, the word i of the block, the sine constant k and the shift s.
+#define STEP(f, a, b, c, d, i, k, s)                                                                                   \
 	{                                                                                                                  \
-		f = F(b, c, d);                                                                                                \
-		g = i;                                                                                                         \
+		a += f(b, c, d) + x[i] + (k);                                                                                  \
+		a  = ROTL(a, s) + b;                                                                                           \
 	}
 
-#define ROUND2(a, b, c, d, f, g, i)                                                                                    \
-	{                                                                                                                  \
-		f = G(b, c, d);                                                                                                \
-		g = (5 * i + 1) % 16;                                                                                          \
-	}
+/**
+ * @brief Compress one block, the 64 steps are unrolled with the word indices, sines and shifts of RFC 1321 as
+ * immediates.
+ */
+static void md5_update_block(struct md5_ctx *ctx, const uint8_t *blk) {
+	uint32_t a = ctx->a, b = ctx->b, c = ctx->c, d = ctx->d;
+	uint32_t x[16];
 
-#define ROUND3(a, b, c, d, f, g, i)                                                                                    \
-	{                                                                                                                  \
-		f = H(b, c, d);                                                                                                \
-		g = (3 * i + 5) % 16;                                                                                          \
-	}
+	// MD5 reads little endian words, the block may not be aligned. __builtin_memcpy keeps the copy inlined.
+	__builtin_memcpy(x, blk, sizeof x);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	for (size_t i = 0; i < 16; i++) x[i] = bswap_32(x[i]);
+#endif
 
-#define ROUND4(a, b, c, d, f, g, i)                                                                                    \
-	{                                                                                                                  \
-		f = I(b, c, d);                                                                                                \
-		g = (7 * i) % 16;                                                                                              \
-	}
+	MD5_STEPS(STEP);
 
-void md5_update(struct md5_ctx *ctx, const uint8_t *input) {
-	uint32_t *data = (uint32_t *) input;
-	uint32_t  a, b, c, d;
+	ctx->a += a;
+	ctx->b += b;
+	ctx->c += c;
+	ctx->d += d;
+}
 
-	a = ctx->a;
-	b = ctx->b;
-	c = ctx->c;
-	d = ctx->d;
+#undef STEP
 
-	for (int i = 0; i < 64; i++) {
-		uint32_t f, g;
+void md5_compress(struct md5_ctx *ctx, const uint8_t *blks, size_t nb) {
+	for (size_t i = 0; i < nb; i++) md5_update_block(ctx, blks + i * MD5_BLK_LEN);
+}
 
-		if (0 <= i && i < 16)
-			ROUND1(a, b, c, d, f, g, i)
-		else if (16 <= i && i < 32)
-			ROUND2(a, b, c, d, f, g, i)
-		else if (32 <= i && i < 48)
-			ROUND3(a, b, c, d, f, g, i)
-		else
-			ROUND4(a, b, c, d, f, g, i)
+void md5_update(struct md5_ctx *ctx, const uint8_t *data, size_t len) {
+	ctx->len += len;
+	if (ctx->blk_len) {// Complete the pending block first
+		size_t missing = MD5_BLK_LEN - ctx->blk_len;
 
-		f += a + ctx->buf[i] + data[g];
-		a = d;
-		d = c;
-		c = b;
-		b += ROTL(f, ctx->shift[i]);
+		if (len < missing) {
+			ft_memcpy(ctx->blk + ctx->blk_len, data, len);
+			ctx->blk_len += len;
+			return;
+		}
+		ft_memcpy(ctx->blk + ctx->blk_len, data, missing);
+		md5_compress(ctx, ctx->blk, 1);
+		ctx->blk_len = 0;
+		data        += missing;
+		len         -= missing;
 	}
 
-	ctx->a += a;
-	ctx->b += b;
-	ctx->c += c;
-	ctx->d += d;
-}
\ No newline at end of file
+	size_t nb = len / MD5_BLK_LEN;
+	md5_compress(ctx, data, nb);
+
+	ctx->blk_len = len - nb * MD5_BLK_LEN;
+	if (ctx->blk_len)
+		ft_memcpy(ctx->blk, data + nb * MD5_BLK_LEN, ctx->blk_len);
+}
@@ -0,0 +1,105 @@
+#include "bench.hh"
+#include "pbkdf.h"
+#include <cstdlib>
+#include <vector>
+
+// Logins verified in bulk: 32 passwords with 1000 iterations each, the throughput is in passwords per second.
+#define NB_PASSWORDS 32
+#define ITERATIONS 1000
+
+static std::vector<struct pbkdf2_hmac_req> make_reqs(enum hmac_algorithm algo) {
+	static uint8_t                      password[] = "password", salt[] = "salt";
+	std::vector<struct pbkdf2_hmac_req> reqs(NB_PASSWORDS);
+
+	for (auto &req : reqs) {
+		req.algo         = algo;
+		req.password     = password;
+		req.password_len = sizeof password - 1;
+		req.salt         = salt;
+		req.salt_len     = sizeof salt - 1;
+		req.iterations   = ITERATIONS;
+		req.dklen        = 32;
+	}
+	return reqs;
+}
+
+static bool pbkdf2_one_by_one(enum hmac_algorithm algo, size_t iterations) {
+	const auto reqs = make_reqs(algo);
+
+	for (size_t i = 0; i < iterations; i++) {
+		for (const auto &req : reqs) {
+			uint8_t *dk = pbkdf2(req);
+			bench::do_not_optimize(dk);
+			free(dk);
+		}
+	}
+	return true;
+}
+
+static bool pbkdf2_batch(enum hmac_algorithm algo, size_t iterations) {
+	const auto reqs = make_reqs(algo);
+	uint8_t   *dks[NB_PASSWORDS];
+
+	for (size_t i = 0; i < iterations; i++) {
+		if (!pbkdf2_many(reqs.data(), NB_PASSWORDS, dks))
+			return false;
+		bench::do_not_optimize(dks);
+		for (uint8_t *dk : dks) free(dk);
+	}
+	return true;
+}
+
+BENCH(pbkdf2_sha2_256_32_passwords, 0) {
+	return pbkdf2_one_by_one(HMAC_SHA2_256, iterations);
+}
+
+BENCH(pbkdf2_many_sha2_256_32_passwords, 0) {
+	return pbkdf2_batch(HMAC_SHA2_256, iterations);
+}
+
+BENCH(pbkdf2_sha2_512_32_passwords, 0) {
+	return pbkdf2_one_by_one(HMAC_SHA2_512, iterations);
+}
+
+BENCH(pbkdf2_many_sha2_512_32_passwords, 0) {
+	return pbkdf2_batch(HMAC_SHA2_512, iterations);
+}
+
+// Cost of a derivation per algorithm and number of threads, the rate is in PBKDF2 iterations (HMAC) per second:
+// a key of 4 blocks gives each thread a share of the work, 4 * RATE_ITERATIONS iterations are computed per run.
+#define RATE_BLOCKS 4
+#define RATE_ITERATIONS 10000
+
+static bool pbkdf2_rate(enum hmac_algorithm algo, uint64_t hlen, size_t threads, size_t iterations) {
+	struct pbkdf2_hmac_req req = make_reqs(algo)[0];
+
+	req.iterations = RATE_ITERATIONS;
+	req.dklen      = RATE_BLOCKS * hlen;
+	req.threads    = threads;
+	for (size_t i = 0; i < iterations; i++) {
+		uint8_t *dk = pbkdf2(req);
+		if (!dk)
+			return false;
+		bench::do_not_optimize(dk);
+		free(dk);
+	}
+	return true;
+}
+
+#define PBKDF2_RATE_BENCH(name, algo, hlen, threads)                                                                   \
+	BENCH_RATE(pbkdf2_rate_##name##_##threads##_threads, RATE_BLOCKS * RATE_ITERATIONS, "it/s") {                      \
+		return pbkdf2_rate(algo, hlen, threads, iterations);                                                           \
+	}
+
+#define PBKDF2_RATE_BENCHES(name, algo, hlen)                                                                          \
+	PBKDF2_RATE_BENCH(name, algo, hlen, 1)                                                                             \
+	PBKDF2_RATE_BENCH(name, algo, hlen, 2)                                                                             \
+	PBKDF2_RATE_BENCH(name, algo, hlen, 4)
+
+PBKDF2_RATE_BENCHES(md5, HMAC_MD5, 16)
+PBKDF2_RATE_BENCHES(sha2_224, HMAC_SHA2_224, 28)
+PBKDF2_RATE_BENCHES(sha2_256, HMAC_SHA2_256, 32)
+PBKDF2_RATE_BENCHES(sha2_384, HMAC_SHA2_384, 48)
+PBKDF2_RATE_BENCHES(sha2_512, HMAC_SHA2_512, 64)
+PBKDF2_RATE_BENCHES(sha2_512_224, HMAC_SHA2_512_224, 28)
+PBKDF2_RATE_BENCHES(sha2_512_256, HMAC_SHA2_512_256, 32)
@@ -7,69 +7,399 @@
  * @see https://tools.ietf.org/html/rfc2898
  */
 
+#define _GNU_SOURCE
+
 #include <stdlib.h>
 #include <stdio.h>
-#include <math.h>
-#include <string.h>
+#include <time.h>
 #include "pbkdf.h"
 #include "common.h"
+#include "libft.h"
+#include "common/internal.h"
 
-uint8_t *pbkdf2(struct pbkdf2_hmac_req req)
+/**
+ * @brief The PRF of PBKDF2 (HMAC) keyed with the password.
+ *
+ * From the second iteration on, the message of the HMAC is the previous U, L bytes long. The inner and the outer
+ * hashes then both end with a single block holding L bytes after the block of the padded key: blk is that block,
+ * with the padding and the length already in place, so that an iteration only writes the L first bytes of blk and
+ * compresses it twice.
+ */
+struct pbkdf2_prf
+{
+	struct hmac_key		key;					  ///< The password, with the inner and outer midstates.
+	union hmac_hash_ctx	ctx;					  ///< The context compressing blk, its state is reset from key.
+	uint8_t				blk[SHA2_MAX_BLOCK_SIZE]; ///< U (the first L bytes), followed by the padding.
+	size_t				b;						  ///< Block size of the hash function.
+};
+
+/**
+ * @brief Prepare the PRF for a password.
+ *
+ * @return false if the algorithm is unknown.
+ */
+static bool pbkdf2_prf_init(struct pbkdf2_prf *prf, enum hmac_algorithm algo, const uint8_t *password, size_t len)
+{
+	if (!hmac_key_init(&prf->key, algo, password, len))
+		return false;
+
+	prf->ctx = prf->key.inner;
+	prf->b = algo == HMAC_MD5 ? MD5_BLOCK_SIZE : prf->ctx.sha2.block_size;
+
+	// Both hashes are b + L bytes long, the length is big endian for SHA2 and little endian for MD5.
+	uint64_t bits = (uint64_t)(prf->b + prf->key.L) << 3;
+	ft_memset(prf->blk, 0, sizeof prf->blk);
+	prf->blk[prf->key.L] = 0x80;
+	for (size_t i = 0; i < 8; i++, bits >>= 8)
+	{
+		if (algo == HMAC_MD5)
+			prf->blk[prf->b - 8 + i] = (uint8_t)bits;
+		else
+			prf->blk[prf->b - 1 - i] = (uint8_t)bits;
+	}
+	return true;
+}
+
+/**
+ * @brief Compress blk into the context, starting from the given midstate, then store the digest in the L first
+ * bytes of blk.
+ */
+static void pbkdf2_prf_hash(struct pbkdf2_prf *prf, const union hmac_hash_ctx *midstate)
 {
-	struct hmac_req hmac_req;
+	if (prf->key.alg == HMAC_MD5)
+	{
+		prf->ctx.md5.a = midstate->md5.a;
+		prf->ctx.md5.b = midstate->md5.b;
+		prf->ctx.md5.c = midstate->md5.c;
+		prf->ctx.md5.d = midstate->md5.d;
+		md5_compress(&prf->ctx.md5, prf->blk, 1);
+		md5_store_digest(&prf->ctx.md5, prf->blk);
+	}
+	else
+	{
+		ft_memcpy(prf->ctx.sha2.state_64, midstate->sha2.state_64, sizeof prf->ctx.sha2.state_64);
+		sha2_compress(&prf->ctx.sha2, prf->blk, 1);
+		sha2_store_digest(&prf->ctx.sha2, prf->blk);
+	}
+}
 
-	hmac_req.ctx = hmac_setup(req.algo);
+/**
+ * @brief Compute U_1 = PRF(P, S || INT(i)), the first iteration of the block T_i of the derived key.
+ *
+ * @param prf The PRF.
+ * @param req The PBKDF2 request.
+ * @param i The index of the block (starting at 1).
+ * @param u The buffer to store U_1 in, L bytes long.
+ */
+static void pbkdf2_first(const struct pbkdf2_prf *prf, const struct pbkdf2_hmac_req *req, uint32_t i, uint8_t *u)
+{
+	struct hmac_ctx	ctx;
+	uint8_t			tmp_i[4] = {(uint8_t)(i >> 24), (uint8_t)(i >> 16), (uint8_t)(i >> 8), (uint8_t)i};
 
-	if (hmac_req.ctx.H == NULL || hmac_req.ctx.b == 0 || hmac_req.ctx.L == 0)
+	hmac_init_key(&ctx, &prf->key);
+	hmac_update(&ctx, req->salt, req->salt_len);
+	hmac_update(&ctx, tmp_i, sizeof tmp_i);
+	hmac_final(&ctx, u);
+}
+
+/**
+ * @brief Compute the block T_i of the derived key.
+ *
+ * @param prf The PRF, its block is overwritten.
+ * @param req The PBKDF2 request.
+ * @param i The index of the block (starting at 1).
+ * @param t The buffer to store the block in, L bytes long.
+ */
+static void pbkdf2_block(struct pbkdf2_prf *prf, const struct pbkdf2_hmac_req *req, uint32_t i, uint8_t *t)
+{
+	const size_t	L = prf->key.L;
+
+	if (req->iterations == 0)
+	{
+		ft_memset(t, 0, L);
+		return;
+	}
+
+	pbkdf2_first(prf, req, i, prf->blk);
+	ft_memcpy(t, prf->blk, L);
+
+	// U_j = PRF(P, U_{j - 1}): two compressions of the pre-padded block.
+	for (uint32_t j = 2; j <= req->iterations; j++)
+	{
+		pbkdf2_prf_hash(prf, &prf->key.inner);
+		pbkdf2_prf_hash(prf, &prf->key.outer);
+		for (size_t k = 0; k < L; k++)
+			t[k] ^= prf->blk[k];
+	}
+}
+
+/**
+ * @brief Arguments of pbkdf2_job.
+ */
+struct pbkdf2_job
+{
+	const struct pbkdf2_prf		   *prf; ///< The PRF keyed with the password, copied by each job.
+	const struct pbkdf2_hmac_req   *req; ///< The PBKDF2 request.
+	uint8_t						   *dk;	 ///< The derived key.
+	size_t							l;	 ///< Number of blocks of the derived key.
+	size_t							r;	 ///< Number of bytes of the last block.
+};
+
+/**
+ * @brief Compute the block T_(i + 1) of the derived key, with its own copy of the PRF so that the blocks can be
+ * computed concurrently.
+ */
+static void pbkdf2_job(void *arg, size_t i)
+{
+	const struct pbkdf2_job	*job = arg;
+	struct pbkdf2_prf		prf = *job->prf;
+	const size_t			L = prf.key.L;
+	uint8_t					t[SHA2_MAX_DIGEST_SIZE];
+
+	pbkdf2_block(&prf, job->req, (uint32_t)(i + 1), t);
+	ft_memcpy(job->dk + i * L, t, i + 1 == job->l ? job->r : L);
+
+	// Setting the PRF and the block to 0 to avoid exposing the password midstates.
+	ft_memset(t, 0, sizeof t);
+	ft_memset(&prf, 0, sizeof prf);
+}
+
+uint8_t *pbkdf2(struct pbkdf2_hmac_req req)
+{
+	struct pbkdf2_prf prf;
+
+	if (!pbkdf2_prf_init(&prf, req.algo, req.password, req.password_len))
 		return NULL;
-	if (req.dklen > (uint64_t)(UINT32_MAX) * hmac_req.ctx.L)
+
+	const size_t L = prf.key.L;
+	if (req.dklen > (uint64_t)(UINT32_MAX) * L)
 	{
 		fprintf(stderr, "Error: pbkdf2: dklen too large\n");
+		hmac_key_wipe(&prf.key);
 		return NULL;
 	}
-	hmac_req.key = req.password;
-	hmac_req.key_len = req.password_len;
 
 	uint8_t *dk = calloc(req.dklen, sizeof *dk);
 	if (dk == NULL)
+	{
+		hmac_key_wipe(&prf.key);
 		return NULL;
+	}
+
+	// The blocks of the derived key are independent, the last one is truncated to r bytes.
+	struct pbkdf2_job job = {.prf = &prf, .req = &req, .dk = dk, .l = (req.dklen + L - 1) / L};
+	job.r = req.dklen - (job.l - 1) * L;
+	if (req.threads > 1 && job.l > 1)
+		parallel_for(job.l, req.threads < job.l ? req.threads : job.l, pbkdf2_job, &job);
+	else
+		for (size_t i = 0; i < job.l; i++)
+			pbkdf2_job(&job, i);
+
+	// Setting the PRF to 0 to avoid exposing the password midstates.
+	ft_memset(&prf, 0, sizeof prf);
+	return dk;
+}
 
-	size_t l = (size_t)ceilf((float)req.dklen / (float)hmac_req.ctx.L);
-	size_t r = req.dklen - (l - 1) * hmac_req.ctx.L;
+/**
+ * @brief Words of the interleaved arrays of the PBKDF2 kernels, 32 or 64 bits depending on the algorithm.
+ */
+static uint64_t pbkdf2_get_word(const uint64_t *words, size_t ws, size_t idx)
+{
+	return ws == 4 ? ((const uint32_t *)words)[idx] : words[idx];
+}
+
+static void pbkdf2_set_word(uint64_t *words, size_t ws, size_t idx, uint64_t value)
+{
+	if (ws == 4)
+		((uint32_t *)words)[idx] = (uint32_t)value;
+	else
+		words[idx] = value;
+}
+
+static uint64_t pbkdf2_load_be(const uint8_t *bytes, size_t ws)
+{
+	uint64_t value = 0;
 
-	// Compute the current block of the derived key.
-	for (size_t i = 1; i <= l; i++)
+	for (size_t i = 0; i < ws; i++)
+		value = value << 8 | bytes[i];
+	return value;
+}
+
+/**
+ * @brief PBKDF2 on the lanes of a SHA2 kernel, every (request, block) pair taking a lane.
+ *
+ * U_1 is computed one lane at a time, then the kernel runs the other iterations of all the lanes at once. The words
+ * of the blocks are big endian, like the digests.
+ */
+static void pbkdf2_many_lanes(const struct sha2_lanes *lanes, const struct pbkdf2_hmac_req *reqs, size_t n,
+							  uint8_t **dks)
+{
+	struct pbkdf2_prf	prf;
+	uint64_t			t[8 * SHA2_MAX_LANES], u[8 * SHA2_MAX_LANES], mask[16], pad[16];
+	uint64_t			inner[8 * SHA2_MAX_LANES], outer[8 * SHA2_MAX_LANES];
+	uint8_t				bytes[SHA2_MAX_BLOCK_SIZE];
+	size_t				lane_req[SHA2_MAX_LANES], cur = n;
+	uint32_t			lane_blk[SHA2_MAX_LANES];
+	size_t				r = 0, L = 0, ws = 0;
+	uint32_t			i = 1;
+
+	while (r < n)
 	{
-		uint8_t t[hmac_req.ctx.L];
-		memset(t, 0, hmac_req.ctx.L);
+		size_t nb = 0;
+
+		ft_memset(t, 0, sizeof t);
+		ft_memset(u, 0, sizeof u);
+		ft_memset(inner, 0, sizeof inner);
+		ft_memset(outer, 0, sizeof outer);
+
+		// Fill the lanes with the next blocks, the idle lanes compute garbage from zeros.
+		for (; nb < lanes->nb && r < n; nb++)
+		{
+			if (cur != r)
+			{
+				ft_memset(&prf, 0, sizeof prf);
+				pbkdf2_prf_init(&prf, reqs[r].algo, reqs[r].password, reqs[r].password_len);
+				cur = r;
+				L = prf.key.L;
+				ws = prf.b / 16; // A block is 16 words.
+
+				// The mask and the padding of the block holding U, the padding is already in blk.
+				for (size_t w = 0; w < 16; w++)
+				{
+					for (size_t k = 0; k < ws; k++)
+						bytes[w * ws + k] = w * ws + k < L ? 0xff : 0;
+					pbkdf2_set_word(mask, ws, w, pbkdf2_load_be(bytes + w * ws, ws));
+					pbkdf2_set_word(pad, ws, w, pbkdf2_load_be(prf.blk + w * ws, ws));
+				}
+			}
+
+			ft_memset(bytes, 0, sizeof bytes);
+			pbkdf2_first(&prf, reqs + r, i, bytes);
+			for (size_t w = 0; w < 8; w++)
+			{
+				pbkdf2_set_word(t, ws, w * lanes->nb + nb, pbkdf2_load_be(bytes + w * ws, ws));
+				pbkdf2_set_word(u, ws, w * lanes->nb + nb, pbkdf2_load_be(bytes + w * ws, ws));
+				pbkdf2_set_word(inner, ws, w * lanes->nb + nb, ws == 4 ? prf.key.inner.sha2.state_32[w]
+																	  : prf.key.inner.sha2.state_64[w]);
+				pbkdf2_set_word(outer, ws, w * lanes->nb + nb, ws == 4 ? prf.key.outer.sha2.state_32[w]
+																	  : prf.key.outer.sha2.state_64[w]);
+			}
+			lane_req[nb] = r;
+			lane_blk[nb] = i;
+
+			// Next block, or first block of the next request.
+			if ((uint64_t)i * L < reqs[r].dklen)
+				i++;
+			else
+			{
+				r++;
+				i = 1;
+			}
+		}
 
-		uint32_t tmp_i = bswap_32(i);
+		lanes->pbkdf2(t, u, inner, outer, mask, pad, reqs[0].iterations - 1);
 
-		size_t len = (req.salt_len + 4 > hmac_req.ctx.L) ? req.salt_len + 4 : hmac_req.ctx.L;
+		for (size_t l = 0; l < nb; l++)
+		{
+			const struct pbkdf2_hmac_req	*req = reqs + lane_req[l];
+			const size_t					offset = (size_t)(lane_blk[l] - 1) * L;
+
+			for (size_t w = 0; w < 8; w++)
+			{
+				uint64_t word = pbkdf2_get_word(t, ws, w * lanes->nb + l);
+				for (size_t k = ws; k--; word >>= 8)
+					bytes[w * ws + k] = (uint8_t)word;
+			}
+			ft_memcpy(dks[lane_req[l]] + offset, bytes, req->dklen - offset < L ? req->dklen - offset : L);
+		}
+	}
 
-		uint8_t u[len];
-		memcpy(u, req.salt, req.salt_len);
-		memcpy(u + req.salt_len, &tmp_i, 4);
+	// Setting the lanes to 0 to avoid exposing the passwords and the derived keys.
+	ft_memset(&prf, 0, sizeof prf);
+	ft_memset(t, 0, sizeof t);
+	ft_memset(u, 0, sizeof u);
+	ft_memset(inner, 0, sizeof inner);
+	ft_memset(outer, 0, sizeof outer);
+	ft_memset(bytes, 0, sizeof bytes);
+}
+
+bool pbkdf2_many(const struct pbkdf2_hmac_req *reqs, size_t n, uint8_t **dks)
+{
+	struct hmac_func func = hmac_setup(n ? reqs[0].algo : HMAC_MD5);
 
-		for (size_t j = 1; j <= req.iterations; j++)
+	for (size_t r = 0; r < n; r++)
+		dks[r] = NULL;
+	for (size_t r = 0; r < n; r++)
+	{
+		if (reqs[r].algo != reqs[0].algo || reqs[r].iterations != reqs[0].iterations || func.H == NULL ||
+			reqs[r].dklen == 0 || reqs[r].dklen > (uint64_t)(UINT32_MAX) * func.L)
+			return false;
+	}
+
+	// The lanes only help from the second iteration on, MD5 has no PBKDF2 kernel.
+	const struct sha2_lanes *lanes = NULL;
+	enum SHA2_ALG sha2_alg;
+	if (n > 1 && reqs[0].iterations > 1 && hmac_sha2_alg(reqs[0].algo, &sha2_alg))
+		lanes = sha2_select_pbkdf2_lanes(sha2_alg);
+
+	for (size_t r = 0; r < n; r++)
+	{
+		dks[r] = lanes ? calloc(reqs[r].dklen, sizeof *dks[r]) : pbkdf2(reqs[r]);
+		if (dks[r] == NULL)
 		{
-			uint8_t tmp_u[hmac_req.ctx.L];
-			hmac_req.message = u;
-			hmac_req.message_len = (j == 1) ? req.salt_len + 4 : hmac_req.ctx.L;
-			hmac_req.res_hmac = tmp_u;
-			hmac(hmac_req);
-
-			for (size_t k = 0; k < hmac_req.ctx.L; k++)
-				u[k] = tmp_u[k];
-			for (size_t k = 0; k < hmac_req.ctx.L; k++)
-				t[k] ^= u[k];
+			for (size_t k = 0; k < r; k++)
+			{
+				ft_memset(dks[k], 0, reqs[k].dklen);
+				free(dks[k]);
+				dks[k] = NULL;
+			}
+			return false;
 		}
+	}
+	if (lanes)
+		pbkdf2_many_lanes(lanes, reqs, n, dks);
+	return true;
+}
 
-		// Copy t to dk
-		if (i == l)
-			memcpy(dk + (i - 1) * hmac_req.ctx.L, t, r);
-		else
-			memcpy(dk + (i - 1) * hmac_req.ctx.L, t, hmac_req.ctx.L);
+#define PBKDF2_CALIBRATE_START	1024	 ///< Number of iterations of the first measure.
+#define PBKDF2_CALIBRATE_MIN_NS 50000000///< A measure must last that long (50 ms) to be extrapolated.
+
+/**
+ * @brief Get a monotonic time in nanoseconds.
+ */
+static uint64_t pbkdf2_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+uint32_t pbkdf2_calibrate(struct pbkdf2_hmac_req req, uint64_t budget_ns)
+{
+	const uint64_t	min_ns = budget_ns < PBKDF2_CALIBRATE_MIN_NS ? budget_ns : PBKDF2_CALIBRATE_MIN_NS;
+	uint64_t		elapsed;
+
+	if (req.dklen == 0)
+		return 0;
+
+	// Double the number of iterations until a derivation lasts long enough to be measured, then extrapolate.
+	for (req.iterations = PBKDF2_CALIBRATE_START;; req.iterations *= 2)
+	{
+		uint64_t	start = pbkdf2_now();
+		uint8_t		*dk = pbkdf2(req);
+
+		elapsed = pbkdf2_now() - start;
+		if (dk == NULL)
+			return 0;
+		ft_memset(dk, 0, req.dklen);
+		free(dk);
+		if (elapsed >= min_ns || req.iterations > UINT32_MAX / 2)
+			break;
 	}
-	return dk;
+
+	double iterations = (double)req.iterations * (double)budget_ns / (double)(elapsed ? elapsed : 1);
+	if (iterations < 1)
+		return 1;
+	return iterations > UINT32_MAX ? UINT32_MAX : (uint32_t)iterations;
 }
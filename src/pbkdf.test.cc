@@ -1,5 +1,6 @@
 #include "pbkdf.h"
 #include <gtest/gtest.h>
+#include <openssl/evp.h>
 #include <memory>
 #include <vector>
 
@@ -129,3 +130,159 @@ TEST(pbkdf2, pbkdf_test_16_4096) {
 
 	EXPECT_EQ(actual, expected);
 }
+
+TEST(pbkdf2, pbkdf_test_openssl) {
+	const struct {
+		enum hmac_algorithm algo;
+		const EVP_MD *(*evp)();
+	} algos[] = {
+		{ HMAC_MD5, EVP_md5 },			   { HMAC_SHA2_224, EVP_sha224 },		  { HMAC_SHA2_256, EVP_sha256 },
+		{ HMAC_SHA2_384, EVP_sha384 },	   { HMAC_SHA2_512, EVP_sha512 },		  { HMAC_SHA2_512_224, EVP_sha512_224 },
+		{ HMAC_SHA2_512_256, EVP_sha512_256 },
+	};
+	const std::string password(150, 'p'), salt = "NaCl and some pepper";
+
+	for (const auto &algo : algos) {
+		const size_t L = EVP_MD_get_size(algo.evp());
+
+		for (uint32_t iterations : { 1, 2, 1000 }) {
+			for (size_t dklen : { (size_t) 1, L, L + 1, 3 * L - 5 }) {
+				for (size_t password_len : { (size_t) 0, (size_t) 8, password.size() }) {
+					struct pbkdf2_hmac_req req {};
+					req.algo		 = algo.algo;
+					req.password	 = (uint8_t *) password.data();
+					req.password_len = password_len;
+					req.salt		 = (uint8_t *) salt.data();
+					req.salt_len	 = salt.size();
+					req.iterations	 = iterations;
+					req.dklen		 = dklen;
+
+					std::vector<uint8_t> expected(dklen);
+					PKCS5_PBKDF2_HMAC(password.data(), (int) password_len, (const uint8_t *) salt.data(),
+									  (int) salt.size(), (int) iterations, algo.evp(), (int) dklen, expected.data());
+
+					std::unique_ptr<uint8_t> dk(pbkdf2(req));
+					ASSERT_NE(dk, nullptr);
+					EXPECT_EQ(std::vector<uint8_t>(dk.get(), dk.get() + dklen), expected)
+						<< EVP_MD_get0_name(algo.evp()) << ", c = " << iterations << ", dklen = " << dklen
+						<< ", password_len = " << password_len;
+				}
+			}
+		}
+	}
+}
+
+TEST(pbkdf2, pbkdf_test_threads) {
+	const std::string password = "password", salt = "salt";
+
+	for (auto [algo, evp, dklen] : { std::make_tuple(HMAC_SHA2_256, EVP_sha256, 96), // AES-256 + HMAC key bundle
+									 std::make_tuple(HMAC_SHA2_512, EVP_sha512, 200),
+									 std::make_tuple(HMAC_MD5, EVP_md5, 33) }) {
+		std::vector<uint8_t> expected(dklen);
+		PKCS5_PBKDF2_HMAC(password.data(), (int) password.size(), (const uint8_t *) salt.data(), (int) salt.size(),
+						  1000, evp(), dklen, expected.data());
+
+		for (size_t threads : { 0, 1, 2, 3, 16 }) {
+			struct pbkdf2_hmac_req req {};
+			req.algo		 = algo;
+			req.password	 = (uint8_t *) password.data();
+			req.password_len = password.size();
+			req.salt		 = (uint8_t *) salt.data();
+			req.salt_len	 = salt.size();
+			req.iterations	 = 1000;
+			req.dklen		 = dklen;
+			req.threads		 = threads;
+
+			std::unique_ptr<uint8_t> dk(pbkdf2(req));
+			ASSERT_NE(dk, nullptr);
+			EXPECT_EQ(std::vector<uint8_t>(dk.get(), dk.get() + dklen), expected)
+				<< EVP_MD_get0_name(evp()) << ", threads = " << threads;
+		}
+	}
+}
+
+TEST(pbkdf2, pbkdf_test_many) {
+	const struct {
+		enum hmac_algorithm algo;
+		const EVP_MD *(*evp)();
+	} algos[] = {
+		{ HMAC_MD5, EVP_md5 },			   { HMAC_SHA2_224, EVP_sha224 },		  { HMAC_SHA2_256, EVP_sha256 },
+		{ HMAC_SHA2_384, EVP_sha384 },	   { HMAC_SHA2_512, EVP_sha512 },		  { HMAC_SHA2_512_224, EVP_sha512_224 },
+		{ HMAC_SHA2_512_256, EVP_sha512_256 },
+	};
+
+	for (const auto &algo : algos) {
+		for (size_t n : { 1, 3, 17, 40 }) {
+			std::vector<std::string>			passwords, salts;
+			std::vector<struct pbkdf2_hmac_req> reqs(n);
+			std::vector<uint8_t *>				dks(n);
+
+			for (size_t r = 0; r < n; r++) {
+				passwords.push_back(std::string(r * 7 % 150, (char) ('a' + r % 26)));
+				salts.push_back("salt " + std::to_string(r));
+			}
+			for (size_t r = 0; r < n; r++) {
+				reqs[r].algo		 = algo.algo;
+				reqs[r].password	 = (uint8_t *) passwords[r].data();
+				reqs[r].password_len = passwords[r].size();
+				reqs[r].salt		 = (uint8_t *) salts[r].data();
+				reqs[r].salt_len	 = salts[r].size();
+				reqs[r].iterations	 = 50;
+				reqs[r].dklen		 = 1 + r * 13 % 100;
+			}
+
+			ASSERT_TRUE(pbkdf2_many(reqs.data(), n, dks.data()));
+			for (size_t r = 0; r < n; r++) {
+				std::vector<uint8_t> expected(reqs[r].dklen);
+				PKCS5_PBKDF2_HMAC(passwords[r].data(), (int) passwords[r].size(), (const uint8_t *) salts[r].data(),
+								  (int) salts[r].size(), 50, algo.evp(), (int) reqs[r].dklen, expected.data());
+				EXPECT_EQ(std::vector<uint8_t>(dks[r], dks[r] + reqs[r].dklen), expected)
+					<< EVP_MD_get0_name(algo.evp()) << ", n = " << n << ", r = " << r;
+				free(dks[r]);
+			}
+		}
+	}
+}
+
+TEST(pbkdf2, pbkdf_test_many_invalid) {
+	struct pbkdf2_hmac_req reqs[2] {};
+	uint8_t				  *dks[2];
+
+	for (auto &req : reqs) {
+		req.algo	   = HMAC_SHA2_256;
+		req.password   = (uint8_t *) "password";
+		req.salt	   = (uint8_t *) "salt";
+		req.salt_len   = 4;
+		req.iterations = 10;
+		req.dklen	   = 32;
+	}
+	reqs[1].iterations = 11;
+	EXPECT_FALSE(pbkdf2_many(reqs, 2, dks));
+	EXPECT_EQ(dks[0], nullptr);
+	EXPECT_EQ(dks[1], nullptr);
+
+	reqs[1].iterations = 10;
+	reqs[1].algo	   = HMAC_SHA2_512;
+	EXPECT_FALSE(pbkdf2_many(reqs, 2, dks));
+}
+
+TEST(pbkdf2, pbkdf_test_calibrate) {
+	struct pbkdf2_hmac_req req {};
+	req.algo		 = HMAC_SHA2_256;
+	req.password	 = (uint8_t *) "password";
+	req.password_len = 8;
+	req.salt		 = (uint8_t *) "salt";
+	req.salt_len	 = 4;
+	req.dklen		 = 32;
+
+	uint32_t short_budget = pbkdf2_calibrate(req, 10000000), long_budget = pbkdf2_calibrate(req, 1000000000);
+	EXPECT_GT(short_budget, 0u);
+	EXPECT_GT(long_budget, short_budget);
+	EXPECT_EQ(pbkdf2_calibrate(req, 0), 1u);
+
+	req.algo = (enum hmac_algorithm) 42;
+	EXPECT_EQ(pbkdf2_calibrate(req, 10000000), 0u);
+	req.algo  = HMAC_SHA2_256;
+	req.dklen = 0;
+	EXPECT_EQ(pbkdf2_calibrate(req, 10000000), 0u);
+}
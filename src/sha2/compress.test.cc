@@ -0,0 +1,30 @@
+#include "common.h"
+#include "internal.h"
+#include "random.hh"
+#include <array>
+#include <cstring>
+#include <gtest/gtest.h>
+
+// Initial values of SHA-256, any state works but this one is the most realistic.
+static const std::array<uint32_t, 8> sha256_iv{
+	0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+};
+
+TEST(SHA2_Compress_Tests, shani_matches_generic) {
+#ifdef SHA2_HAVE_SHANI
+	if (!cpu_has(CPU_FEATURE_SHA | CPU_FEATURE_SSE41))
+		GTEST_SKIP() << "SHA extensions not supported by this CPU";
+
+	for (size_t nb : { 0, 1, 2, 3, 7, 16, 100 }) {
+		// One extra byte to feed unaligned blocks.
+		std::vector<uint8_t>    data = rng::get_random_data(nb * SHA2_256_BLOCK_SIZE + 1);
+		std::array<uint32_t, 8> expected{ sha256_iv }, state{ sha256_iv };
+
+		sha2_256_compress_generic(expected.data(), data.data() + 1, nb);
+		sha2_256_compress_shani(state.data(), data.data() + 1, nb);
+		EXPECT_EQ(expected, state) << "nb = " << nb;
+	}
+#else
+	GTEST_SKIP() << "SHA extensions kernel not compiled in";
+#endif
+}
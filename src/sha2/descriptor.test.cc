@@ -0,0 +1,174 @@
+#include "crypto.h"
+#include "random.hh"
+#include <cstdio>
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+class SHA2_Descriptor_Tests : public testing::Test {
+protected:
+	std::vector<uint8_t> data;
+	FILE                *file{ nullptr };
+	int                  fd{ -1 };
+
+	// Bigger than a mapping window would be too slow, 3 MiB with an odd tail crosses several pages and blocks.
+	void SetUp() override {
+		data = rng::get_random_data((3 << 20) + 1234);
+		file = std::tmpfile();
+		ASSERT_NE(file, nullptr);
+		fd = fileno(file);
+		ASSERT_EQ(write(fd, data.data(), data.size()), (ssize_t) data.size());
+	}
+
+	void TearDown() override {
+		if (file)
+			fclose(file);
+	}
+
+	std::vector<uint8_t> expected(enum SHA2_ALG alg, size_t offset) const {
+		std::vector<uint8_t> digest(SHA2_MAX_DIGEST_SIZE);
+		sha2_bytes_raw(alg, data.data() + offset, data.size() - offset, digest.data());
+		return digest;
+	}
+
+	std::vector<uint8_t> actual(enum SHA2_ALG alg, size_t offset, const struct hash_io_opts *opts) const {
+		std::vector<uint8_t> digest(SHA2_MAX_DIGEST_SIZE);
+		EXPECT_EQ(lseek(fd, (off_t) offset, SEEK_SET), (off_t) offset);
+		EXPECT_NE(sha2_descriptor_opts_raw(alg, fd, opts, digest.data()), nullptr);
+		EXPECT_EQ(lseek(fd, 0, SEEK_CUR), (off_t) data.size());
+		return digest;
+	}
+};
+
+TEST_F(SHA2_Descriptor_Tests, mapped) {
+	for (auto alg : { SHA2_ALG_256, SHA2_ALG_512 }) {
+		EXPECT_EQ(actual(alg, 0, nullptr), expected(alg, 0));
+		struct hash_io_opts opts = { .flags = HASH_IO_HUGEPAGES };
+		EXPECT_EQ(actual(alg, 0, &opts), expected(alg, 0));
+	}
+}
+
+TEST_F(SHA2_Descriptor_Tests, not_mapped) {
+	struct hash_io_opts opts = { .flags = HASH_IO_NO_MMAP };
+
+	for (auto alg : { SHA2_ALG_256, SHA2_ALG_512 }) EXPECT_EQ(actual(alg, 0, &opts), expected(alg, 0));
+}
+
+TEST_F(SHA2_Descriptor_Tests, from_offset) {
+	// The mapping must start on a page boundary, the offsets are not.
+	for (size_t offset : { (size_t) 1, (size_t) 4097, data.size() - (1 << 16) - 3, data.size() - 10, data.size() })
+		EXPECT_EQ(actual(SHA2_ALG_256, offset, nullptr), expected(SHA2_ALG_256, offset));
+}
+
+TEST_F(SHA2_Descriptor_Tests, pipe) {
+	int pipefd[2];
+	ASSERT_EQ(pipe(pipefd), 0);
+
+	// Less than the capacity of a pipe, the writes cannot block.
+	const size_t len = 60000;
+	ASSERT_EQ(write(pipefd[1], data.data(), len), (ssize_t) len);
+	close(pipefd[1]);
+
+	std::vector<uint8_t> digest(SHA2_MAX_DIGEST_SIZE), ref(SHA2_MAX_DIGEST_SIZE);
+	EXPECT_NE(sha2_descriptor_raw(SHA2_ALG_384, pipefd[0], digest.data()), nullptr);
+	close(pipefd[0]);
+	sha2_bytes_raw(SHA2_ALG_384, data.data(), len, ref.data());
+	EXPECT_EQ(digest, ref);
+}
+
+TEST_F(SHA2_Descriptor_Tests, buffer_sizes) {
+	// The sizes out of range are clamped, the others are rounded to 4 KiB.
+	for (size_t size : { (size_t) 1, (size_t) HASH_IO_MIN_BUFFER_SIZE + 100, (size_t) 1 << 30 }) {
+		struct hash_io_opts opts = { .flags = HASH_IO_NO_MMAP, .buffer_size = size };
+		EXPECT_EQ(actual(SHA2_ALG_512, 3, &opts), expected(SHA2_ALG_512, 3));
+	}
+}
+
+TEST_F(SHA2_Descriptor_Tests, direct) {
+	struct hash_io_opts opts = { .flags = HASH_IO_DIRECT, .buffer_size = 100000 };
+
+	for (size_t offset : { (size_t) 0, (size_t) 5000, data.size() - 1 })
+		EXPECT_EQ(actual(SHA2_ALG_256, offset, &opts), expected(SHA2_ALG_256, offset));
+}
+
+TEST_F(SHA2_Descriptor_Tests, short_reads) {
+	int pipefd[2];
+	ASSERT_EQ(pipe(pipefd), 0);
+
+	// The writer sends odd sized chunks, most reads return less than the buffer before the end of the stream.
+	std::thread writer([&] {
+		for (size_t pos = 0, chunk = 1; pos < data.size(); pos += chunk, chunk = chunk * 3 % 70001 + 1)
+			if (write(pipefd[1], data.data() + pos, std::min(chunk, data.size() - pos)) == -1)
+				break;
+		close(pipefd[1]);
+	});
+
+	std::vector<uint8_t> digest(SHA2_MAX_DIGEST_SIZE);
+	EXPECT_NE(sha2_descriptor_raw(SHA2_ALG_512, pipefd[0], digest.data()), nullptr);
+	writer.join();
+	close(pipefd[0]);
+	EXPECT_EQ(digest, expected(SHA2_ALG_512, 0));
+}
+
+TEST_F(SHA2_Descriptor_Tests, pipelined) {
+	// Depths out of range are clamped, small buffers make the reader wait on the hashing thread.
+	for (size_t depth : { (size_t) 0, (size_t) 1, (size_t) 3, (size_t) 1000 }) {
+		struct hash_io_opts  opts  = { .flags = 0, .buffer_size = HASH_IO_MIN_BUFFER_SIZE, .ring_depth = depth };
+		struct hash_io_stats stats = {};
+		std::vector<uint8_t> digest(SHA2_MAX_DIGEST_SIZE);
+
+		ASSERT_EQ(lseek(fd, 7, SEEK_SET), 7);
+		EXPECT_NE(sha2_descriptor_pipelined_raw(SHA2_ALG_256, fd, &opts, &stats, digest.data()), nullptr);
+		EXPECT_EQ(digest, expected(SHA2_ALG_256, 7));
+		EXPECT_EQ(lseek(fd, 0, SEEK_CUR), (off_t) data.size());
+		EXPECT_GE(stats.nb_chunks, (data.size() - 7) / HASH_IO_MIN_BUFFER_SIZE);
+		EXPECT_GT(stats.hash_ns, 0u);
+	}
+
+	struct hash_io_opts  opts = { .flags = HASH_IO_DIRECT, .buffer_size = 0, .ring_depth = 2 };
+	std::vector<uint8_t> digest(SHA2_MAX_DIGEST_SIZE);
+	ASSERT_EQ(lseek(fd, 5000, SEEK_SET), 5000);
+	EXPECT_NE(sha2_descriptor_pipelined_raw(SHA2_ALG_512, fd, &opts, nullptr, digest.data()), nullptr);
+	EXPECT_EQ(digest, expected(SHA2_ALG_512, 5000));
+}
+
+TEST_F(SHA2_Descriptor_Tests, pipelined_pipe) {
+	int pipefd[2];
+	ASSERT_EQ(pipe(pipefd), 0);
+
+	std::thread writer([&] {
+		for (size_t pos = 0, chunk = 1; pos < data.size(); pos += chunk, chunk = chunk * 5 % 90001 + 1)
+			if (write(pipefd[1], data.data() + pos, std::min(chunk, data.size() - pos)) == -1)
+				break;
+		close(pipefd[1]);
+	});
+
+	std::vector<uint8_t> digest(SHA2_MAX_DIGEST_SIZE);
+	EXPECT_NE(sha2_descriptor_pipelined_raw(SHA2_ALG_224, pipefd[0], nullptr, nullptr, digest.data()), nullptr);
+	writer.join();
+	close(pipefd[0]);
+	EXPECT_EQ(digest, expected(SHA2_ALG_224, 0));
+
+	EXPECT_EQ(sha2_descriptor_pipelined_raw(SHA2_ALG_224, -1, nullptr, nullptr, digest.data()), nullptr);
+}
+
+TEST_F(SHA2_Descriptor_Tests, md5) {
+	uint8_t digest[16], ref[16];
+
+	md5_bytes_raw(data.data(), data.size(), ref);
+	for (int flags : { 0, (int) HASH_IO_NO_MMAP }) {
+		struct hash_io_opts opts = { .flags = flags };
+		ASSERT_EQ(lseek(fd, 0, SEEK_SET), 0);
+		EXPECT_NE(md5_descriptor_opts_raw(fd, &opts, digest), nullptr);
+		EXPECT_EQ(std::vector<uint8_t>(digest, digest + 16), std::vector<uint8_t>(ref, ref + 16));
+	}
+}
+
+TEST_F(SHA2_Descriptor_Tests, bad_descriptor) {
+	uint8_t digest[SHA2_MAX_DIGEST_SIZE];
+
+	EXPECT_EQ(sha2_descriptor_raw(SHA2_ALG_256, -1, digest), nullptr);
+	EXPECT_EQ(md5_descriptor_raw(-1, digest), nullptr);
+}
@@ -12,26 +12,49 @@
 #include <stdio.h>
 
 char *sha2_final(struct sha2 *ctx) {
-	uint8_t digest[ctx->alg.digest_size];
+	uint8_t digest[SHA2_MAX_DIGEST_SIZE];
+	size_t  digest_size = ctx->digest_size;
+
 	sha2_final_raw(ctx, digest);
-	char *str = stringify_hash(digest, ctx->alg.digest_size);
+	return stringify_hash(digest, digest_size);
+}
 
-	free(ctx->ctx_32);// It is an union so we can free either one but not both
-	ft_memset(ctx, 0, sizeof *ctx);
+/**
+ * @brief Append the padding and the length of the message (in bits, big endian) then compress the last block(s).
+ *
+ * @param ctx The context to pad.
+ */
+static void sha2_pad(struct sha2 *ctx) {
+	const size_t len_size = ctx->block_size == SHA2_256_BLOCK_SIZE ? SHA2_256_WANTED_SIZE : SHA2_512_WANTED_SIZE;
+
+	ctx->blk[ctx->blk_len++] = 0x80;// 0b10000000 (first bit after the last byte of data is always set to 1)
+	if (ctx->blk_len > ctx->block_size - len_size) {
+		ft_memset(ctx->blk + ctx->blk_len, 0, ctx->block_size - ctx->blk_len);
+		sha2_compress(ctx, ctx->blk, 1);
+		ctx->blk_len = 0;
+	}
+	ft_memset(ctx->blk + ctx->blk_len, 0, ctx->block_size - ctx->blk_len);
 
-	return str;
+	__uint128_t bits = ctx->len << 3;
+	for (size_t i = 1; i <= len_size; i++, bits >>= 8) ctx->blk[ctx->block_size - i] = (uint8_t) bits;
+	sha2_compress(ctx, ctx->blk, 1);
 }
 
-uint8_t *sha2_final_raw(struct sha2 *ctx, uint8_t *buf) {
-	if (ctx->alg.alg == SHA2_ALG_224 || ctx->alg.alg == SHA2_ALG_256) {
-		for (size_t i = 0; i < 8; i++) ctx->ctx_32->state[i] = bswap_32(ctx->ctx_32->state[i]);
-		ft_memcpy(buf, ctx->ctx_32->state, ctx->alg.digest_size);
-		ft_memset(ctx->ctx_32, 0, sizeof *ctx->ctx_32);
+void sha2_store_digest(struct sha2 *ctx, uint8_t *buf) {
+	if (ctx->alg == SHA2_ALG_224 || ctx->alg == SHA2_ALG_256) {
+		for (size_t i = 0; i < 8; i++) ctx->state_32[i] = bswap_32(ctx->state_32[i]);
+		ft_memcpy(buf, ctx->state_32, ctx->digest_size);
 	} else {
-		for (size_t i = 0; i < 8; i++) ctx->ctx_64->state[i] = bswap_64(ctx->ctx_64->state[i]);
-		ft_memcpy(buf, ctx->ctx_64->state, ctx->alg.digest_size);
-
-		ft_memset(ctx->ctx_64, 0, sizeof *ctx->ctx_64);
+		for (size_t i = 0; i < 8; i++) ctx->state_64[i] = bswap_64(ctx->state_64[i]);
+		ft_memcpy(buf, ctx->state_64, ctx->digest_size);
 	}
+}
+
+uint8_t *sha2_final_raw(struct sha2 *ctx, uint8_t *buf) {
+	sha2_pad(ctx);
+	sha2_store_digest(ctx, buf);
+
+	// Setting the context to 0 to avoid exposing the internal state of the context.
+	ft_memset(ctx, 0, sizeof *ctx);
 	return buf;
 }
@@ -8,11 +8,17 @@
 #ifndef SHA2_INTERNAL_H
 #define SHA2_INTERNAL_H
 
+#include "common.h"
+#include "common/internal.h"
 #include "crypto.h"
 #include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 #define SHA2_224_DIGEST_SIZE 28
 #define SHA2_256_DIGEST_SIZE 32
 #define SHA2_384_DIGEST_SIZE 48
@@ -45,6 +51,17 @@
 #define SHA2_512_224_WANTED_SIZE SHA2_512_WANTED_SIZE
 #define SHA2_512_256_WANTED_SIZE SHA2_512_WANTED_SIZE
 
+// The SHA extensions kernel is compiled in on x86, it is only used if the CPU supports it.
+#if defined(__x86_64__) || defined(__i386__)
+#	define SHA2_HAVE_SHANI
+#endif
+
+// The multi-buffer kernels (AVX2 and AVX-512) are compiled in on x86-64, they are only used if the CPU supports them.
+// They need __builtin_shufflevector (clang, or gcc 12 and later).
+#if defined(__x86_64__) && (defined(__clang__) || __GNUC__ >= 12)
+#	define SHA2_HAVE_LANES
+#endif
+
 #undef Ch
 #undef Ma
 #undef sum0
@@ -65,103 +82,94 @@
 #define SSIG1_64(x) (ROTR(x, 19) ^ ROTR(x, 61) ^ SHR(x, 6))
 
 /**
- * @brief Represents a SHA2 algorithm.
- */
-struct sha2_alg {
-	enum SHA2_ALG alg;         /**< The algorithm. */
-
-	size_t        digest_size; /**< The size of the digest. */
-	size_t        block_size;  /**< The size of the block. */
-	size_t        wanted_size; /**< The size of the wanted digest. */
-	size_t        nb_rounds;   /**< The number of rounds. */
-};
-
-/**
- * @brief Represents a SHA2 context within 32bit (i.e. SHA2-224 or SHA2-256).
+ * @brief Round constants of SHA-224 and SHA-256 (RFC 6234).
  */
-struct sha2_ctx_32 {
-	struct sha2_alg data; /**< The algorithm. */
-
-	union {
-		uint32_t state[8]; /**< The state. */
-		uint8_t  hash[32]; /**< The current hash. */
-	};
-
-	const uint32_t *cnsts; /**< The constants. */
-};
+extern const uint32_t sha2_csts32[SHA2_256_NB_ROUNDS] __visibility_internal;
 
 /**
- * @brief Represents a SHA2 context within 64bit (i.e. SHA2-384, SHA2-512, SHA2-512_224 or SHA2-512_256).
+ * @brief Round constants of SHA-384, SHA-512, SHA-512/224 and SHA-512/256 (RFC 6234).
  */
-struct sha2_ctx_64 {
-	struct sha2_alg data;
-
-	union {
-		uint64_t state[8]; /**< The state. */
-		uint8_t  hash[64]; /**< The current hash. */
-	};
-
-	const uint64_t *cnsts; /**< The constants. */
-};
+extern const uint64_t sha2_csts64[SHA2_512_NB_ROUNDS] __visibility_internal;
 
 /**
- * @brief Represents a SHA2 context with every thing needed to compute a SHA2 hash.
- */
-struct sha2 {
-	struct sha2_alg alg; /**< The algorithm. */
-
-	union// As its an union of pointers it takes exactly 8 bytes and avoid the need of a pointer to void.
-	{
-		struct sha2_ctx_32 *ctx_32; /**< The context for 32bit. */
-		struct sha2_ctx_64 *ctx_64; /**< The context for 64bit. */
-	};
-};
-
-/**
- * @brief Setup the sha2 context depending on the given algorithm.
+ * @brief Portable SHA-256 compression function.
  *
- * @param ctx The context to initialize.
- * @param alg The algorithm.
+ * The rounds are fully unrolled with the constants as immediates, and the message schedule is computed on the fly
+ * in a window of 16 words.
+ *
+ * @param state The chaining state (a to h).
+ * @param blks The blocks to compress, they do not need to be aligned.
+ * @param nb The number of blocks.
  */
-void     sha2_init(struct sha2 *ctx, enum SHA2_ALG alg);
+void sha2_256_compress_generic(uint32_t *state, const uint8_t *blks, size_t nb) __visibility_internal;
 
 /**
- * @brief Frees the context after using it.
+ * @brief Portable SHA-512 compression function (also used by SHA-384, SHA-512/224 and SHA-512/256).
  *
- * @param ctx The context to free.
- * @param alg The algorithm.
+ * @param state The chaining state (a to h).
+ * @param blks The blocks to compress, they do not need to be aligned.
+ * @param nb The number of blocks.
  */
-void     sha2_free(struct sha2 *ctx, enum SHA2_ALG alg);
+void sha2_512_compress_generic(uint64_t *state, const uint8_t *blks, size_t nb) __visibility_internal;
 
+#ifdef SHA2_HAVE_SHANI
 /**
- * @brief Update the context with the given data.
+ * @brief SHA-256 compression function using the x86 SHA extensions.
  *
- * @param ctx The context to update.
- * @param data The data to update the context with.
+ * @param state The chaining state (a to h).
+ * @param blks The blocks to compress, they do not need to be aligned.
+ * @param nb The number of blocks.
  *
- * @note The data must be a void pointer since we do not know which kind of algorithm we are using.
+ * @warning This function must only be called if cpu_has(CPU_FEATURE_SHA | CPU_FEATURE_SSE41) is true.
+ * @note The result is identical to sha2_256_compress_generic.
  */
-void     sha2_update(struct sha2 *ctx, void *data);
+void sha2_256_compress_shani(uint32_t *state, const uint8_t *blks, size_t nb) __visibility_internal;
+#endif
+
+#ifdef SHA2_HAVE_LANES
+void sha2_256_compress_x8(void *state, const uint8_t *const *blks) __visibility_internal; ///< AVX2
+void sha2_256_compress_x16(void *state, const uint8_t *const *blks) __visibility_internal;///< AVX-512F
+void sha2_512_compress_x4(void *state, const uint8_t *const *blks) __visibility_internal; ///< AVX2
+void sha2_512_compress_x8(void *state, const uint8_t *const *blks) __visibility_internal; ///< AVX-512F
+
+void sha2_256_pbkdf2_x8(void *t, void *u, const void *inner, const void *outer, const void *mask, const void *pad,
+                        uint32_t iterations) __visibility_internal;///< AVX2
+void sha2_256_pbkdf2_x16(void *t, void *u, const void *inner, const void *outer, const void *mask, const void *pad,
+                         uint32_t iterations) __visibility_internal;///< AVX-512F
+void sha2_512_pbkdf2_x4(void *t, void *u, const void *inner, const void *outer, const void *mask, const void *pad,
+                        uint32_t iterations) __visibility_internal;///< AVX2
+void sha2_512_pbkdf2_x8(void *t, void *u, const void *inner, const void *outer, const void *mask, const void *pad,
+                        uint32_t iterations) __visibility_internal;///< AVX-512F
+#endif
 
 /**
- * @brief Return the final hash string.
- *
- * @param ctx The context to get the hash from.
- *
- * @return The hash string.
+ * @brief Select the best multi-buffer kernel for the algorithm on this CPU.
  *
- * @warning This function returns a malloc-ed string which must be freed by the caller.
+ * @return The kernel, or NULL if there is none (or if hashing the messages one by one is faster).
  */
-char    *sha2_final(struct sha2 *ctx);
+const struct sha2_lanes *sha2_select_lanes(enum SHA2_ALG alg) __visibility_internal;
 
 /**
- * @brief Put the hash in the given buffer.
+ * @brief Hash several messages with the given multi-buffer kernel.
  *
- * @param ctx The context to get the hash from.
- * @param buf The buffer to put the hash in.
+ * Each lane of the kernel hashes one message, a lane is refilled with the next message as soon as its message is
+ * done. Once there are not enough messages left to keep half of the lanes busy, the remaining ones are finished
+ * with the single buffer compression function.
  *
- * @return The buffer itself.
+ * @param alg The algorithm to use.
+ * @param lanes The kernel to use, it must match the word size of the algorithm.
+ * @param msgs The messages.
+ * @param lens The length of each message.
+ * @param n The number of messages.
+ * @param out The buffer to store the digests in (n digests stored one after the other).
+ *
+ * @return The given buffer, or NULL if the algorithm is unknown.
  */
-uint8_t *sha2_final_raw(struct sha2 *ctx, uint8_t *buf);
+uint8_t *sha2_many_lanes(enum SHA2_ALG alg, const struct sha2_lanes *lanes, const uint8_t *const *msgs,
+                         const size_t *lens, size_t n, uint8_t *out) __visibility_internal;
+
+#ifdef __cplusplus
+}
+#endif
 
 #endif
@@ -0,0 +1,146 @@
+/**
+ * @file lanes.c
+ * @author Ghali Boucetta (gboucett@student.42.fr)
+ * @brief SHA-2 compression functions working on several independent messages at once.
+ * @date 2026-10-17
+ *
+ * Each vector holds the same word of the state of several messages (one message per lane), so the rounds are
+ * computed for all the lanes with the same instructions. The kernels are written with the GCC vector extensions
+ * and compiled for the instruction set they target, the scheduling of the messages is done in many.c.
+ */
+
+#include "internal.h"
+
+#ifdef SHA2_HAVE_LANES
+
+// The kernels use __builtin_memcpy instead of ft_memcpy so that the unaligned vector loads are inlined.
+
+// ROTR from common.h relies on sizeof, which is the size of the whole vector here.
+#	define VROTR32(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+#	define VROTR64(x, n) (((x) >> (n)) | ((x) << (64 - (n))))
+
+#	define VBSIG0_32(x) (VROTR32(x, 2) ^ VROTR32(x, 13) ^ VROTR32(x, 22))
+#	define VBSIG1_32(x) (VROTR32(x, 6) ^ VROTR32(x, 11) ^ VROTR32(x, 25))
+#	define VSSIG0_32(x) (VROTR32(x, 7) ^ VROTR32(x, 18) ^ ((x) >> 3))
+#	define VSSIG1_32(x) (VROTR32(x, 17) ^ VROTR32(x, 19) ^ ((x) >> 10))
+
+#	define VBSIG0_64(x) (VROTR64(x, 28) ^ VROTR64(x, 34) ^ VROTR64(x, 39))
+#	define VBSIG1_64(x) (VROTR64(x, 14) ^ VROTR64(x, 18) ^ VROTR64(x, 41))
+#	define VSSIG0_64(x) (VROTR64(x, 1) ^ VROTR64(x, 8) ^ ((x) >> 7))
+#	define VSSIG1_64(x) (VROTR64(x, 19) ^ VROTR64(x, 61) ^ ((x) >> 6))
+
+#	define VBSWAP32(x) (((x) << 24) | (((x) &0xff00) << 8) | (((x) >> 8) & 0xff00) | ((x) >> 24))
+#	define VBSWAP64(x) ((VBSWAP32((x) >> 32) & 0xffffffff) | (VBSWAP32((x) &0xffffffff) << 32))
+
+// One round, the variables are rotated by the caller instead of being moved around.
+#	define VROUND(a, b, c, d, e, f, g, h, k, w, bits)                                                                  \
+		{                                                                                                              \
+			t1 = h + VBSIG1_##bits(e) + Ch(e, f, g) + (k) + (w);                                                       \
+			d += t1;                                                                                                   \
+			h  = t1 + VBSIG0_##bits(a) + Ma(a, b, c);                                                                  \
+		}
+
+// Word of the first 16 rounds, taken as is from the blocks.
+#	define VLOAD(i, bits) w[i]
+
+// Word of the next rounds, computed in place in the window of the last 16 words.
+#	define VSCHED(i, bits)                                                                                             \
+		(w[i] += VSSIG1_##bits(w[((i) + 14) & 15]) + w[((i) + 9) & 15] + VSSIG0_##bits(w[((i) + 1) & 15]))
+
+// 16 rounds starting at the round j, W gives the word of the round (j + i).
+#	define VROUNDS(j, W, bits)                                                                                         \
+		{                                                                                                              \
+			VROUND(a, b, c, d, e, f, g, h, sha2_csts##bits[(j) + 0], W(0, bits), bits);                                \
+			VROUND(h, a, b, c, d, e, f, g, sha2_csts##bits[(j) + 1], W(1, bits), bits);                                \
+			VROUND(g, h, a, b, c, d, e, f, sha2_csts##bits[(j) + 2], W(2, bits), bits);                                \
+			VROUND(f, g, h, a, b, c, d, e, sha2_csts##bits[(j) + 3], W(3, bits), bits);                                \
+			VROUND(e, f, g, h, a, b, c, d, sha2_csts##bits[(j) + 4], W(4, bits), bits);                                \
+			VROUND(d, e, f, g, h, a, b, c, sha2_csts##bits[(j) + 5], W(5, bits), bits);                                \
+			VROUND(c, d, e, f, g, h, a, b, sha2_csts##bits[(j) + 6], W(6, bits), bits);                                \
+			VROUND(b, c, d, e, f, g, h, a, sha2_csts##bits[(j) + 7], W(7, bits), bits);                                \
+			VROUND(a, b, c, d, e, f, g, h, sha2_csts##bits[(j) + 8], W(8, bits), bits);                                \
+			VROUND(h, a, b, c, d, e, f, g, sha2_csts##bits[(j) + 9], W(9, bits), bits);                                \
+			VROUND(g, h, a, b, c, d, e, f, sha2_csts##bits[(j) + 10], W(10, bits), bits);                              \
+			VROUND(f, g, h, a, b, c, d, e, sha2_csts##bits[(j) + 11], W(11, bits), bits);                              \
+			VROUND(e, f, g, h, a, b, c, d, sha2_csts##bits[(j) + 12], W(12, bits), bits);                              \
+			VROUND(d, e, f, g, h, a, b, c, sha2_csts##bits[(j) + 13], W(13, bits), bits);                              \
+			VROUND(c, d, e, f, g, h, a, b, sha2_csts##bits[(j) + 14], W(14, bits), bits);                              \
+			VROUND(b, c, d, e, f, g, h, a, sha2_csts##bits[(j) + 15], W(15, bits), bits);                              \
+		}
+
+/**
+ * @brief Defines a SHA-2 compression function for a given number of lanes and word size (32 or 64 bits).
+ *
+ * The state is stored word by word: state[i * lanes + l] is the word i of the lane l. The message schedule only
+ * keeps the last 16 words, the first ones being loaded (and byte swapped) from each lane's block.
+ */
+#	define DEFINE_SHA2_LANES(name, isa, vtype, lanes, bits, nb_rounds)                                                 \
+		__attribute__((target(isa))) void name(void *state_ptr, const uint8_t *const *blks) {                          \
+			uint##bits##_t *state = state_ptr;                                                                         \
+			vtype           s[8], w[16];                                                                               \
+			vtype           a, b, c, d, e, f, g, h, t1;                                                                \
+                                                                                                                       \
+			__builtin_memcpy(s, state, sizeof s);                                                                      \
+			VLOAD_BLOCKS(vtype, lanes, w, VBSWAP##bits);                                                               \
+                                                                                                                       \
+			a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];                            \
+			VROUNDS(0, VLOAD, bits);                                                                                   \
+			for (size_t j = 16; j < (nb_rounds); j += 16) VROUNDS(j, VSCHED, bits);                                    \
+			s[0] += a, s[1] += b, s[2] += c, s[3] += d, s[4] += e, s[5] += f, s[6] += g, s[7] += h;                    \
+			__builtin_memcpy(state, s, sizeof s);                                                                      \
+		}
+
+/**
+ * @brief Defines a PBKDF2 kernel (the HMAC iterations of several passwords at once) for a given number of lanes and
+ * word size.
+ *
+ * The message of each HMAC is the previous U, so the words of the blocks are built from the state words with the
+ * mask and the padding of the block instead of being loaded, and everything stays in registers between the
+ * iterations.
+ */
+#	define DEFINE_SHA2_PBKDF2_LANES(name, isa, vtype, lanes, bits, nb_rounds)                                          \
+		__attribute__((target(isa))) void name(void *t_ptr, void *u_ptr, const void *inner_ptr, const void *outer_ptr, \
+		                                       const void *mask_ptr, const void *pad_ptr, uint32_t iterations) {       \
+			const uint##bits##_t *mask = mask_ptr, *pad = pad_ptr;                                                     \
+			vtype                 t[8], u[8], inner[8], outer[8], w[16];                                               \
+			vtype                 a, b, c, d, e, f, g, h, t1;                                                          \
+                                                                                                                       \
+			__builtin_memcpy(t, t_ptr, sizeof t);                                                                      \
+			__builtin_memcpy(u, u_ptr, sizeof u);                                                                      \
+			__builtin_memcpy(inner, inner_ptr, sizeof inner);                                                          \
+			__builtin_memcpy(outer, outer_ptr, sizeof outer);                                                          \
+                                                                                                                       \
+			for (uint32_t it = 0; it < iterations; it++) {                                                             \
+				for (size_t i = 0; i < 16; i++) w[i] = (i < 8 ? u[i] & mask[i] : (vtype){}) | pad[i];                  \
+				a = inner[0], b = inner[1], c = inner[2], d = inner[3];                                                \
+				e = inner[4], f = inner[5], g = inner[6], h = inner[7];                                                \
+				VROUNDS(0, VLOAD, bits);                                                                               \
+				for (size_t j = 16; j < (nb_rounds); j += 16) VROUNDS(j, VSCHED, bits);                                \
+				u[0] = inner[0] + a, u[1] = inner[1] + b, u[2] = inner[2] + c, u[3] = inner[3] + d;                    \
+				u[4] = inner[4] + e, u[5] = inner[5] + f, u[6] = inner[6] + g, u[7] = inner[7] + h;                    \
+                                                                                                                       \
+				for (size_t i = 0; i < 16; i++) w[i] = (i < 8 ? u[i] & mask[i] : (vtype){}) | pad[i];                  \
+				a = outer[0], b = outer[1], c = outer[2], d = outer[3];                                                \
+				e = outer[4], f = outer[5], g = outer[6], h = outer[7];                                                \
+				VROUNDS(0, VLOAD, bits);                                                                               \
+				for (size_t j = 16; j < (nb_rounds); j += 16) VROUNDS(j, VSCHED, bits);                                \
+				u[0] = outer[0] + a, u[1] = outer[1] + b, u[2] = outer[2] + c, u[3] = outer[3] + d;                    \
+				u[4] = outer[4] + e, u[5] = outer[5] + f, u[6] = outer[6] + g, u[7] = outer[7] + h;                    \
+                                                                                                                       \
+				for (size_t i = 0; i < 8; i++) t[i] ^= u[i];                                                           \
+			}                                                                                                          \
+			__builtin_memcpy(t_ptr, t, sizeof t);                                                                      \
+			__builtin_memcpy(u_ptr, u, sizeof u);                                                                      \
+		}
+
+DEFINE_SHA2_LANES(sha2_256_compress_x8, "avx2", v8u32, 8, 32, SHA2_256_NB_ROUNDS)
+DEFINE_SHA2_LANES(sha2_256_compress_x16, "avx512f", v16u32, 16, 32, SHA2_256_NB_ROUNDS)
+DEFINE_SHA2_LANES(sha2_512_compress_x4, "avx2", v4u64, 4, 64, SHA2_512_NB_ROUNDS)
+DEFINE_SHA2_LANES(sha2_512_compress_x8, "avx512f", v8u64, 8, 64, SHA2_512_NB_ROUNDS)
+
+DEFINE_SHA2_PBKDF2_LANES(sha2_256_pbkdf2_x8, "avx2", v8u32, 8, 32, SHA2_256_NB_ROUNDS)
+DEFINE_SHA2_PBKDF2_LANES(sha2_256_pbkdf2_x16, "avx512f", v16u32, 16, 32, SHA2_256_NB_ROUNDS)
+DEFINE_SHA2_PBKDF2_LANES(sha2_512_pbkdf2_x4, "avx2", v4u64, 4, 64, SHA2_512_NB_ROUNDS)
+DEFINE_SHA2_PBKDF2_LANES(sha2_512_pbkdf2_x8, "avx512f", v8u64, 8, 64, SHA2_512_NB_ROUNDS)
+
+#endif
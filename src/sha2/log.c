@@ -0,0 +1,220 @@
+/**
+ * @file log.c
+ * @author Ghali Boucetta (gboucett@student.42.fr)
+ * @brief Hashing of append-only logs, with the midstates of regularly spaced prefixes kept in a sidecar index.
+ * @date 2026-10-17
+ *
+ * The index starts with a header (SHA2_LOG_HEADER_SIZE bytes): the magic, a format version, the algorithm, then the
+ * interval (64 bits, big endian). It is followed by one record per checkpoint, the record i being the midstate
+ * exported after (i + 1) * interval bytes of the log.
+ */
+
+#define _GNU_SOURCE
+
+#include "internal.h"
+#include "libft.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define SHA2_LOG_MAGIC "SHA2LG"///< First bytes of an index.
+#define SHA2_LOG_MAGIC_SIZE 6  ///< Size of the magic.
+#define SHA2_LOG_FORMAT 1      ///< Version of the layout of the index.
+#define SHA2_LOG_HEADER_SIZE 16///< Magic, version, algorithm and interval.
+#define SHA2_LOG_READ_SIZE (1 << 16)///< Size of the reads between a checkpoint and the requested offset.
+
+/**
+ * @brief Header of an index.
+ */
+struct sha2_log_index {
+	enum SHA2_ALG alg;     ///< The algorithm.
+	uint64_t      interval;///< Number of bytes between two checkpoints.
+	size_t        nb;      ///< Number of complete records.
+};
+
+/**
+ * @brief State of sha2_log_index_update, while the log is read.
+ */
+struct sha2_log {
+	struct sha2 ctx;     ///< The hash of the log so far.
+	uint64_t    interval;///< Number of bytes between two checkpoints.
+	uint64_t    next;    ///< Offset of the next checkpoint.
+	uint8_t    *records; ///< The new checkpoints.
+	size_t      nb;      ///< Number of new checkpoints.
+	size_t      cap;     ///< Number of checkpoints records can hold.
+	bool        error;   ///< Set if an allocation failed.
+};
+
+static bool sha2_log_pread(int fd, void *buf, size_t len, uint64_t offset) {
+	uint8_t *dst = buf;
+
+	while (len) {
+		ssize_t ret = pread(fd, dst, len, (off_t) offset);
+		if (ret < 0 && errno == EINTR)
+			continue;
+		if (ret <= 0)
+			return false;
+		dst += ret;
+		len -= (size_t) ret;
+		offset += (uint64_t) ret;
+	}
+	return true;
+}
+
+static bool sha2_log_pwrite(int fd, const void *buf, size_t len, uint64_t offset) {
+	const uint8_t *src = buf;
+
+	while (len) {
+		ssize_t ret = pwrite(fd, src, len, (off_t) offset);
+		if (ret < 0 && errno == EINTR)
+			continue;
+		if (ret <= 0)
+			return false;
+		src += ret;
+		len -= (size_t) ret;
+		offset += (uint64_t) ret;
+	}
+	return true;
+}
+
+/**
+ * @brief Read the header of an index.
+ *
+ * @return false if the index cannot be read or is not an index.
+ */
+static bool sha2_log_read_index(int index_fd, struct sha2_log_index *index) {
+	uint8_t     header[SHA2_LOG_HEADER_SIZE];
+	struct stat st;
+	struct sha2 ctx;
+
+	if (fstat(index_fd, &st) == -1 || (uint64_t) st.st_size < SHA2_LOG_HEADER_SIZE)
+		return false;
+	if (!sha2_log_pread(index_fd, header, sizeof header, 0))
+		return false;
+	if (memcmp(header, SHA2_LOG_MAGIC, SHA2_LOG_MAGIC_SIZE) != 0 || header[6] != SHA2_LOG_FORMAT)
+		return false;
+
+	index->alg      = (enum SHA2_ALG) header[7];
+	index->interval = 0;
+	for (size_t i = 8; i < SHA2_LOG_HEADER_SIZE; i++) index->interval = index->interval << 8 | header[i];
+	index->nb = ((uint64_t) st.st_size - SHA2_LOG_HEADER_SIZE) / SHA2_MIDSTATE_SIZE;
+	return index->interval && sha2_init(&ctx, index->alg);
+}
+
+/**
+ * @brief Read the checkpoint i of an index into a context.
+ *
+ * @return false if the checkpoint cannot be read or does not match its position.
+ */
+static bool sha2_log_checkpoint(int index_fd, const struct sha2_log_index *index, size_t i, struct sha2 *ctx) {
+	uint8_t midstate[SHA2_MIDSTATE_SIZE];
+
+	if (!sha2_log_pread(index_fd, midstate, sizeof midstate, SHA2_LOG_HEADER_SIZE + i * SHA2_MIDSTATE_SIZE))
+		return false;
+	if (!sha2_import(ctx, midstate))
+		return false;
+	return ctx->alg == index->alg && ctx->len == (__uint128_t) (i + 1) * index->interval;
+}
+
+static void sha2_log_update(void *arg, const uint8_t *data, size_t len) {
+	struct sha2_log *log = arg;
+
+	while (len && !log->error) {
+		uint64_t left = log->next - (uint64_t) log->ctx.len;
+		size_t   n    = len < left ? len : (size_t) left;
+
+		sha2_update(&log->ctx, data, n);
+		data += n;
+		len -= n;
+		if ((uint64_t) log->ctx.len != log->next)
+			continue;
+
+		if (log->nb == log->cap) {
+			size_t   cap     = log->cap ? 2 * log->cap : 16;
+			uint8_t *records = realloc(log->records, cap * SHA2_MIDSTATE_SIZE);
+			if (!records) {
+				log->error = true;
+				return;
+			}
+			log->records = records;
+			log->cap     = cap;
+		}
+		sha2_export(&log->ctx, log->records + log->nb++ * SHA2_MIDSTATE_SIZE);
+		log->next += log->interval;
+	}
+}
+
+bool sha2_log_index_update(enum SHA2_ALG alg, int log_fd, int index_fd, uint64_t interval) {
+	struct sha2_log_index index;
+	struct sha2_log       log = { .records = NULL };
+	struct stat           st;
+
+	// Only an empty index is initialized, anything else must be a valid index for the same algorithm.
+	if (fstat(index_fd, &st) == -1)
+		return false;
+	if (st.st_size == 0) {
+		uint8_t header[SHA2_LOG_HEADER_SIZE] = SHA2_LOG_MAGIC;
+
+		index = (struct sha2_log_index){ .alg = alg, .interval = interval ? interval : SHA2_LOG_DEFAULT_INTERVAL };
+		if (!sha2_init(&log.ctx, alg))
+			return false;
+		header[6] = SHA2_LOG_FORMAT;
+		header[7] = (uint8_t) alg;
+		for (size_t i = 0; i < 8; i++) header[15 - i] = (uint8_t) (index.interval >> (8 * i));
+		if (!sha2_log_pwrite(index_fd, header, sizeof header, 0))
+			return false;
+	} else if (!sha2_log_read_index(index_fd, &index) || index.alg != alg) {
+		return false;
+	}
+
+	// Resume from the last checkpoint, a log shorter than it has been truncated.
+	if (index.nb ? !sha2_log_checkpoint(index_fd, &index, index.nb - 1, &log.ctx) : !sha2_init(&log.ctx, alg))
+		return false;
+	if (fstat(log_fd, &st) == -1 || (uint64_t) st.st_size < (uint64_t) log.ctx.len ||
+	    lseek(log_fd, (off_t) log.ctx.len, SEEK_SET) == -1)
+		return false;
+
+	log.interval = index.interval;
+	log.next     = (uint64_t) log.ctx.len + index.interval;
+	bool ok      = hash_descriptor(log_fd, NULL, sha2_log_update, &log) && !log.error;
+	if (ok && log.nb)
+		ok = sha2_log_pwrite(index_fd, log.records, log.nb * SHA2_MIDSTATE_SIZE,
+		                     SHA2_LOG_HEADER_SIZE + index.nb * SHA2_MIDSTATE_SIZE);
+
+	free(log.records);
+	ft_memset(&log.ctx, 0, sizeof log.ctx);
+	return ok;
+}
+
+uint8_t *sha2_log_digest_raw(int log_fd, int index_fd, uint64_t offset, uint8_t *buf) {
+	struct sha2_log_index index;
+	struct sha2           ctx;
+	uint8_t              *chunk;
+
+	if (!sha2_log_read_index(index_fd, &index))
+		return NULL;
+
+	// The nearest checkpoint at or before the offset.
+	size_t i = offset / index.interval < index.nb ? offset / index.interval : index.nb;
+	if (i ? !sha2_log_checkpoint(index_fd, &index, i - 1, &ctx) : !sha2_init(&ctx, index.alg))
+		return NULL;
+
+	chunk = malloc(SHA2_LOG_READ_SIZE);
+	if (!chunk)
+		return NULL;
+	for (uint64_t pos = (uint64_t) ctx.len; pos < offset;) {
+		size_t len = offset - pos < SHA2_LOG_READ_SIZE ? (size_t) (offset - pos) : SHA2_LOG_READ_SIZE;
+
+		if (!sha2_log_pread(log_fd, chunk, len, pos)) {
+			free(chunk);
+			ft_memset(&ctx, 0, sizeof ctx);
+			return NULL;
+		}
+		sha2_update(&ctx, chunk, len);
+		pos += len;
+	}
+	free(chunk);
+	return sha2_final_raw(&ctx, buf);
+}
@@ -0,0 +1,109 @@
+#include "crypto.h"
+#include "random.hh"
+#include <cstdio>
+#include <gtest/gtest.h>
+#include <openssl/evp.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+typedef std::vector<uint8_t> bytes;
+
+class SHA2_Log_Tests : public testing::Test {
+protected:
+	FILE *log   = nullptr;
+	FILE *index = nullptr;
+	bytes data;
+
+	void SetUp() override {
+		log   = std::tmpfile();
+		index = std::tmpfile();
+		ASSERT_NE(log, nullptr);
+		ASSERT_NE(index, nullptr);
+	}
+
+	void TearDown() override {
+		fclose(log);
+		fclose(index);
+	}
+
+	void append(size_t len) {
+		bytes more = rng::get_random_data(len);
+		ASSERT_EQ(pwrite(fileno(log), more.data(), more.size(), (off_t) data.size()), (ssize_t) more.size());
+		data.insert(data.end(), more.begin(), more.end());
+	}
+
+	static bytes expected(const EVP_MD *md, const bytes &data, size_t offset) {
+		bytes out(EVP_MD_get_size(md));
+		EVP_Digest(data.data(), offset, out.data(), nullptr, md, nullptr);
+		return out;
+	}
+
+	void check(const EVP_MD *md, size_t offset) {
+		bytes actual(EVP_MD_get_size(md));
+		ASSERT_NE(sha2_log_digest_raw(fileno(log), fileno(index), offset, actual.data()), nullptr) << offset;
+		EXPECT_EQ(actual, expected(md, data, offset)) << offset;
+	}
+
+	size_t nb_checkpoints() const {
+		struct stat st;
+		fstat(fileno(index), &st);
+		return ((size_t) st.st_size - 16) / SHA2_MIDSTATE_SIZE;
+	}
+};
+
+TEST_F(SHA2_Log_Tests, checkpoints) {
+	const size_t interval = 1000;
+
+	append(3500);
+	ASSERT_TRUE(sha2_log_index_update(SHA2_ALG_256, fileno(log), fileno(index), interval));
+	EXPECT_EQ(nb_checkpoints(), data.size() / interval);
+	for (size_t offset : { 0, 1, 999, 1000, 1001, 2500, 3000 }) check(EVP_sha256(), offset);
+	check(EVP_sha256(), data.size());
+
+	// Appended bytes are hashed from the last checkpoint, the interval of the index is kept.
+	append(100000);
+	ASSERT_TRUE(sha2_log_index_update(SHA2_ALG_256, fileno(log), fileno(index), 42));
+	EXPECT_EQ(nb_checkpoints(), data.size() / interval);
+	for (size_t offset : { 2999, 3000, 4000, 50123, 99999 }) check(EVP_sha256(), offset);
+	check(EVP_sha256(), data.size());
+
+	// Nothing new.
+	ASSERT_TRUE(sha2_log_index_update(SHA2_ALG_256, fileno(log), fileno(index), interval));
+	EXPECT_EQ(nb_checkpoints(), data.size() / interval);
+
+	bytes digest(32);
+	EXPECT_EQ(sha2_log_digest_raw(fileno(log), fileno(index), data.size() + 1, digest.data()), nullptr);
+}
+
+TEST_F(SHA2_Log_Tests, sha512_mapped) {
+	// Big enough for the log to be mapped, with an interval that is not a multiple of the block size.
+	const size_t interval = 12345;
+
+	append(300000);
+	ASSERT_TRUE(sha2_log_index_update(SHA2_ALG_512, fileno(log), fileno(index), interval));
+	EXPECT_EQ(nb_checkpoints(), data.size() / interval);
+	for (size_t offset : { 0, 12344, 12345, 12346, 123456, 299999 }) check(EVP_sha512(), offset);
+}
+
+TEST_F(SHA2_Log_Tests, errors) {
+	append(5000);
+	ASSERT_TRUE(sha2_log_index_update(SHA2_ALG_256, fileno(log), fileno(index), 1000));
+
+	// Another algorithm, or a log truncated before the last checkpoint.
+	EXPECT_FALSE(sha2_log_index_update(SHA2_ALG_384, fileno(log), fileno(index), 1000));
+	ASSERT_EQ(ftruncate(fileno(log), 4500), 0);
+	EXPECT_FALSE(sha2_log_index_update(SHA2_ALG_256, fileno(log), fileno(index), 1000));
+
+	// A corrupted checkpoint.
+	uint8_t byte = 0xff;
+	ASSERT_EQ(pwrite(fileno(index), &byte, 1, 16 + 2 * SHA2_MIDSTATE_SIZE + 5), 1);
+	bytes digest(32);
+	EXPECT_EQ(sha2_log_digest_raw(fileno(log), fileno(index), 3500, digest.data()), nullptr);
+	EXPECT_NE(sha2_log_digest_raw(fileno(log), fileno(index), 2500, digest.data()), nullptr);
+
+	// Something that is not an index is never overwritten.
+	ASSERT_EQ(pwrite(fileno(index), "garbage", 7, 0), 7);
+	EXPECT_FALSE(sha2_log_index_update(SHA2_ALG_256, fileno(log), fileno(index), 1000));
+	EXPECT_EQ(sha2_log_digest_raw(fileno(log), fileno(index), 10, digest.data()), nullptr);
+}
@@ -0,0 +1,103 @@
+/**
+ * @file many.c
+ * @author Ghali Boucetta (gboucett@student.42.fr)
+ * @brief Multi-buffer SHA-2: hash a batch of independent messages with the SIMD kernels of lanes.c.
+ * @date 2026-10-17
+ */
+
+#include "internal.h"
+#include "libft.h"
+
+/**
+ * @brief Single buffer compression functions on a bare chaining state, for the leftovers of the lane scheduler.
+ */
+static void sha2_256_compress_state(void *state, const uint8_t *blks, size_t nb) {
+	struct sha2 ctx = { .alg = SHA2_ALG_256 };
+
+	ft_memcpy(ctx.state_32, state, sizeof ctx.state_32);
+	sha2_compress(&ctx, blks, nb);
+	ft_memcpy(state, ctx.state_32, sizeof ctx.state_32);
+}
+
+static void sha2_512_compress_state(void *state, const uint8_t *blks, size_t nb) {
+	sha2_512_compress_generic(state, blks, nb);
+}
+
+uint8_t *sha2_many_lanes(enum SHA2_ALG alg, const struct sha2_lanes *lanes, const uint8_t *const *msgs,
+                         const size_t *lens, size_t n, uint8_t *out) {
+	struct sha2 ctx;
+
+	if (!sha2_init(&ctx, alg))
+		return NULL;
+
+	const bool              is_256 = ctx.block_size == SHA2_256_BLOCK_SIZE;
+	const struct lanes_hash hash   = {
+		.block_size  = ctx.block_size,
+		.len_size    = is_256 ? SHA2_256_WANTED_SIZE : SHA2_512_WANTED_SIZE,
+		.big_endian  = true,
+		.word_size   = is_256 ? sizeof *ctx.state_32 : sizeof *ctx.state_64,
+		.nb_words    = 8,
+		.digest_size = ctx.digest_size,
+		.iv          = ctx.state_64,
+		.compress    = is_256 ? sha2_256_compress_state : sha2_512_compress_state,
+	};
+	return lanes_hash_many(&hash, lanes->nb, lanes->compress, msgs, lens, n, out);
+}
+
+#ifdef SHA2_HAVE_LANES
+static const struct sha2_lanes sha2_256_x16 = { .nb       = 16,
+                                                .compress = sha2_256_compress_x16,
+                                                .pbkdf2   = sha2_256_pbkdf2_x16 };
+static const struct sha2_lanes sha2_256_x8 = { .nb       = 8,
+                                               .compress = sha2_256_compress_x8,
+                                               .pbkdf2   = sha2_256_pbkdf2_x8 };
+static const struct sha2_lanes sha2_512_x8 = { .nb       = 8,
+                                               .compress = sha2_512_compress_x8,
+                                               .pbkdf2   = sha2_512_pbkdf2_x8 };
+static const struct sha2_lanes sha2_512_x4 = { .nb       = 4,
+                                               .compress = sha2_512_compress_x4,
+                                               .pbkdf2   = sha2_512_pbkdf2_x4 };
+#endif
+
+const struct sha2_lanes *sha2_select_lanes(enum SHA2_ALG alg) {
+#ifdef SHA2_HAVE_LANES
+	if (alg == SHA2_ALG_224 || alg == SHA2_ALG_256) {
+		// Hashing the messages one by one with the SHA extensions is faster than 8 lanes of AVX2.
+		if (!cpu_has(CPU_FEATURE_AVX512F) && cpu_has(CPU_FEATURE_SHA | CPU_FEATURE_SSE41))
+			return NULL;
+	}
+#endif
+	return sha2_select_pbkdf2_lanes(alg);
+}
+
+const struct sha2_lanes *sha2_select_pbkdf2_lanes(enum SHA2_ALG alg) {
+#ifdef SHA2_HAVE_LANES
+	if (alg == SHA2_ALG_224 || alg == SHA2_ALG_256) {
+		if (cpu_has(CPU_FEATURE_AVX512F))
+			return &sha2_256_x16;
+		if (cpu_has(CPU_FEATURE_AVX2))
+			return &sha2_256_x8;
+	} else {
+		if (cpu_has(CPU_FEATURE_AVX512F))
+			return &sha2_512_x8;
+		if (cpu_has(CPU_FEATURE_AVX2))
+			return &sha2_512_x4;
+	}
+#else
+	(void) alg;
+#endif
+	return NULL;
+}
+
+uint8_t *sha2_bytes_many(enum SHA2_ALG alg, const uint8_t *const *msgs, const size_t *lens, size_t n, uint8_t *out) {
+	const struct sha2_lanes *lanes = sha2_select_lanes(alg);
+
+	if (lanes)
+		return sha2_many_lanes(alg, lanes, msgs, lens, n, out);
+
+	struct sha2 ctx;
+	if (!sha2_init(&ctx, alg))
+		return NULL;
+	for (size_t i = 0; i < n; i++) sha2_bytes_raw(alg, msgs[i], lens[i], out + i * ctx.digest_size);
+	return out;
+}
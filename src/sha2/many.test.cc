@@ -0,0 +1,195 @@
+#include "common.h"
+#include "crypto.h"
+#include "internal.h"
+#include "random.hh"
+#include <cstring>
+#include <gtest/gtest.h>
+#include <openssl/evp.h>
+#include <vector>
+
+struct SHA2ManyParams {
+	enum SHA2_ALG alg;
+	const EVP_MD *(*evp)();
+	std::string name;
+};
+
+static std::ostream &operator<<(std::ostream &os, const SHA2ManyParams &params) {
+	return os << params.name;
+}
+
+class SHA2_Many_Tests : public testing::TestWithParam<SHA2ManyParams> {
+protected:
+	std::vector<std::vector<uint8_t>> msgs;
+	std::vector<const uint8_t *>      ptrs;
+	std::vector<size_t>               lens;
+	std::vector<uint8_t>              expected;
+	size_t                            digest_size{ 0 };
+
+	// Batch mixing empty messages, lengths around the padding limits and a few long messages.
+	void make_batch(size_t n) {
+		std::uniform_int_distribution<size_t> short_len(0, 300), long_len(1000, 20000);
+
+		for (size_t i = 0; i < n; i++) {
+			size_t len = (i % 11 == 0) ? long_len(rng::engine) : (i < 20 ? i * 7 : short_len(rng::engine));
+			msgs.push_back(rng::get_random_data(len));
+		}
+		for (auto &msg : msgs) {
+			ptrs.push_back(msg.data());
+			lens.push_back(msg.size());
+		}
+
+		digest_size = EVP_MD_get_size(GetParam().evp());
+		expected.resize(n * digest_size);
+		for (size_t i = 0; i < n; i++)
+			EVP_Digest(msgs[i].data(), msgs[i].size(), expected.data() + i * digest_size, nullptr, GetParam().evp(),
+			           nullptr);
+	}
+
+	void check(const struct sha2_lanes *lanes) {
+		for (size_t n : { 0, 1, 3, 8, 9, 16, 17, 100 }) {
+			msgs.clear();
+			ptrs.clear();
+			lens.clear();
+			make_batch(n);
+
+			std::vector<uint8_t> out(n * digest_size);
+			uint8_t             *ret;
+			if (lanes)
+				ret = sha2_many_lanes(GetParam().alg, lanes, ptrs.data(), lens.data(), n, out.data());
+			else
+				ret = sha2_bytes_many(GetParam().alg, ptrs.data(), lens.data(), n, out.data());
+			ASSERT_EQ(ret, out.data());
+			EXPECT_EQ(out, expected) << "n = " << n;
+		}
+	}
+};
+
+TEST_P(SHA2_Many_Tests, dispatched) {
+	check(nullptr);
+}
+
+TEST_P(SHA2_Many_Tests, avx2) {
+#ifdef SHA2_HAVE_LANES
+	if (!cpu_has(CPU_FEATURE_AVX2))
+		GTEST_SKIP() << "AVX2 not supported by this CPU";
+	struct sha2_lanes lanes = { 4, sha2_512_compress_x4 };
+	if (GetParam().alg == SHA2_ALG_224 || GetParam().alg == SHA2_ALG_256)
+		lanes = { 8, sha2_256_compress_x8 };
+	check(&lanes);
+#else
+	GTEST_SKIP() << "Multi-buffer kernels not compiled in";
+#endif
+}
+
+TEST_P(SHA2_Many_Tests, avx512) {
+#ifdef SHA2_HAVE_LANES
+	if (!cpu_has(CPU_FEATURE_AVX512F))
+		GTEST_SKIP() << "AVX-512 not supported by this CPU";
+	struct sha2_lanes lanes = { 8, sha2_512_compress_x8 };
+	if (GetParam().alg == SHA2_ALG_224 || GetParam().alg == SHA2_ALG_256)
+		lanes = { 16, sha2_256_compress_x16 };
+	check(&lanes);
+#else
+	GTEST_SKIP() << "Multi-buffer kernels not compiled in";
+#endif
+}
+
+INSTANTIATE_TEST_SUITE_P(sha2, SHA2_Many_Tests,
+                         testing::Values(SHA2ManyParams{ SHA2_ALG_224, EVP_sha224, "SHA2_224" },
+                                         SHA2ManyParams{ SHA2_ALG_256, EVP_sha256, "SHA2_256" },
+                                         SHA2ManyParams{ SHA2_ALG_384, EVP_sha384, "SHA2_384" },
+                                         SHA2ManyParams{ SHA2_ALG_512, EVP_sha512, "SHA2_512" },
+                                         SHA2ManyParams{ SHA2_ALG_512_224, EVP_sha512_224, "SHA2_512_224" },
+                                         SHA2ManyParams{ SHA2_ALG_512_256, EVP_sha512_256, "SHA2_512_256" }),
+                         [](const testing::TestParamInfo<SHA2ManyParams> &info) { return info.param.name; });
+
+TEST(SHA2_Many_Tests, unknown_algorithm) {
+	const uint8_t *msg = (const uint8_t *) "abc";
+	size_t         len = 3;
+	uint8_t        out[SHA2_MAX_DIGEST_SIZE];
+
+	EXPECT_EQ(sha2_bytes_many((enum SHA2_ALG) 42, &msg, &len, 1, out), nullptr);
+}
+
+#ifdef SHA2_HAVE_LANES
+// One lane of a PBKDF2 kernel computed with the single buffer compression: the block holds U (L bytes, big endian
+// words) followed by the padding of a b + L bytes message.
+template<typename word>
+static void pbkdf2_reference(word *t, word *u, const word *inner, const word *outer, size_t L, uint32_t iterations) {
+	const size_t b = 16 * sizeof(word);
+	uint8_t		 blk[128];
+
+	for (uint32_t it = 0; it < iterations; it++) {
+		for (const word *midstate : { inner, outer }) {
+			word state[8];
+
+			std::memset(blk, 0, sizeof blk);
+			for (size_t i = 0; i < L; i++)
+				blk[i] = (uint8_t) (u[i / sizeof(word)] >> (8 * (sizeof(word) - 1 - i % sizeof(word))));
+			blk[L] = 0x80;
+			for (size_t i = 0, bits = (b + L) * 8; i < 8; i++, bits >>= 8) blk[b - 1 - i] = (uint8_t) bits;
+
+			std::memcpy(state, midstate, sizeof state);
+			if (sizeof(word) == 4)
+				sha2_256_compress_generic((uint32_t *) state, blk, 1);
+			else
+				sha2_512_compress_generic((uint64_t *) state, blk, 1);
+			std::memcpy(u, state, sizeof state);
+		}
+		for (size_t i = 0; i < 8; i++) t[i] ^= u[i];
+	}
+}
+
+template<typename word>
+static void check_pbkdf2_lanes(sha2_pbkdf2_lanes_func kernel, size_t lanes, size_t L) {
+	std::vector<word> t(8 * lanes), u(8 * lanes), inner(8 * lanes), outer(8 * lanes), mask(16), pad(16);
+	std::uniform_int_distribution<word> dist;
+
+	for (auto *v : { &t, &u, &inner, &outer })
+		for (auto &w : *v) w = dist(rng::engine);
+
+	// Mask and padding of the block, L bytes of U then 0x80 and the length.
+	uint8_t blk_mask[128] = {}, blk_pad[128] = {};
+	const size_t b = 16 * sizeof(word);
+	std::memset(blk_mask, 0xff, L);
+	blk_pad[L] = 0x80;
+	for (size_t i = 0, bits = (b + L) * 8; i < 8; i++, bits >>= 8) blk_pad[b - 1 - i] = (uint8_t) bits;
+	for (size_t w = 0; w < 16; w++)
+		for (size_t k = 0; k < sizeof(word); k++) {
+			mask[w] = (word) (mask[w] << 8 | blk_mask[w * sizeof(word) + k]);
+			pad[w]  = (word) (pad[w] << 8 | blk_pad[w * sizeof(word) + k]);
+		}
+
+	std::vector<word> expected_t(t), expected_u(u);
+	for (size_t l = 0; l < lanes; l++) {
+		word lt[8], lu[8], li[8], lo[8];
+		for (size_t i = 0; i < 8; i++) {
+			lt[i] = t[i * lanes + l];
+			lu[i] = u[i * lanes + l];
+			li[i] = inner[i * lanes + l];
+			lo[i] = outer[i * lanes + l];
+		}
+		pbkdf2_reference(lt, lu, li, lo, L, 3);
+		for (size_t i = 0; i < 8; i++) expected_t[i * lanes + l] = lt[i], expected_u[i * lanes + l] = lu[i];
+	}
+
+	kernel(t.data(), u.data(), inner.data(), outer.data(), mask.data(), pad.data(), 3);
+	EXPECT_EQ(t, expected_t) << "L = " << L;
+	EXPECT_EQ(u, expected_u) << "L = " << L;
+}
+#endif
+
+TEST(SHA2_Many_Tests, pbkdf2_kernels) {
+#ifdef SHA2_HAVE_LANES
+	if (!cpu_has(CPU_FEATURE_AVX2))
+		GTEST_SKIP() << "AVX2 not supported by this CPU";
+	for (size_t L : { 28, 32 }) check_pbkdf2_lanes<uint32_t>(sha2_256_pbkdf2_x8, 8, L);
+	for (size_t L : { 28, 32, 48, 64 }) check_pbkdf2_lanes<uint64_t>(sha2_512_pbkdf2_x4, 4, L);
+	if (!cpu_has(CPU_FEATURE_AVX512F))
+		GTEST_SKIP() << "AVX-512 not supported by this CPU";
+	for (size_t L : { 28, 32 }) check_pbkdf2_lanes<uint32_t>(sha2_256_pbkdf2_x16, 16, L);
+	for (size_t L : { 28, 32, 48, 64 }) check_pbkdf2_lanes<uint64_t>(sha2_512_pbkdf2_x8, 8, L);
+#else
+	GTEST_SKIP() << "Multi-buffer kernels not compiled in";
+#endif
+}
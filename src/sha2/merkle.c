@@ -0,0 +1,176 @@
+/**
+ * @file merkle.c
+ * @author Ghali Boucetta (gboucett@student.42.fr)
+ * @brief Merkle trees over SHA2-256 digests, built level by level with the multi-buffer kernels.
+ * @date 2026-10-17
+ */
+
+#include "internal.h"
+#include "libft.h"
+
+#define SHA2_MERKLE_JOB 4096///< Number of nodes hashed by a job, levels with fewer nodes stay on the calling thread.
+
+/**
+ * @brief Second block of every node: the padding of a 64 bytes message, with its length (512 bits) at the end.
+ */
+static const uint8_t sha2_merkle_pad[SHA2_256_BLOCK_SIZE] = { [0] = 0x80, [62] = 0x02 };
+
+/**
+ * @brief A level being hashed by parallel_for.
+ */
+struct sha2_merkle_job {
+	const uint32_t          *iv;   ///< The initial chaining state of SHA2-256.
+	const struct sha2_lanes *lanes;///< The multi-buffer kernel, or NULL.
+	const uint8_t           *level;///< The nodes of the level below, two children per node.
+	uint8_t                 *out;  ///< The nodes of the level.
+	size_t                   n;    ///< The number of nodes to compute.
+};
+
+/**
+ * @brief Hash consecutive nodes one by one.
+ */
+static void sha2_merkle_nodes(const uint32_t *iv, const uint8_t *children, uint8_t *out, size_t n) {
+	struct sha2 ctx = { .alg = SHA2_ALG_256, .digest_size = SHA2_256_DIGEST_SIZE };
+
+	for (size_t i = 0; i < n; i++) {
+		ft_memcpy(ctx.state_32, iv, sizeof ctx.state_32);
+		sha2_compress(&ctx, children + i * SHA2_256_BLOCK_SIZE, 1);
+		sha2_compress(&ctx, sha2_merkle_pad, 1);
+		sha2_store_digest(&ctx, out + i * SHA2_MERKLE_NODE_SIZE);
+	}
+	ft_memset(&ctx, 0, sizeof ctx);
+}
+
+/**
+ * @brief Hash consecutive nodes by groups of one node per lane, the leftovers are hashed one by one.
+ */
+static void sha2_merkle_nodes_lanes(const struct sha2_lanes *lanes, const uint32_t *iv, const uint8_t *children,
+                                    uint8_t *out, size_t n) {
+	const size_t   nb = lanes->nb;
+	uint32_t       state[8 * SHA2_MAX_LANES];
+	const uint8_t *blks[SHA2_MAX_LANES], *pad[SHA2_MAX_LANES];
+	size_t         i = 0;
+
+	for (size_t l = 0; l < nb; l++) pad[l] = sha2_merkle_pad;
+	for (; i + nb <= n; i += nb) {
+		for (size_t w = 0; w < 8; w++)
+			for (size_t l = 0; l < nb; l++) state[w * nb + l] = iv[w];
+		for (size_t l = 0; l < nb; l++) blks[l] = children + (i + l) * SHA2_256_BLOCK_SIZE;
+
+		lanes->compress(state, blks);
+		lanes->compress(state, pad);
+
+		for (size_t l = 0; l < nb; l++) {
+			uint32_t digest[8];
+
+			for (size_t w = 0; w < 8; w++) digest[w] = bswap_32(state[w * nb + l]);
+			ft_memcpy(out + (i + l) * SHA2_MERKLE_NODE_SIZE, digest, sizeof digest);
+		}
+	}
+	sha2_merkle_nodes(iv, children + i * SHA2_256_BLOCK_SIZE, out + i * SHA2_MERKLE_NODE_SIZE, n - i);
+}
+
+static void sha2_merkle_job(void *arg, size_t j) {
+	const struct sha2_merkle_job *job      = arg;
+	const size_t                  first    = j * SHA2_MERKLE_JOB;
+	const size_t                  n        = job->n - first < SHA2_MERKLE_JOB ? job->n - first : SHA2_MERKLE_JOB;
+	const uint8_t                *children = job->level + first * SHA2_256_BLOCK_SIZE;
+	uint8_t                      *out      = job->out + first * SHA2_MERKLE_NODE_SIZE;
+
+	if (job->lanes)
+		sha2_merkle_nodes_lanes(job->lanes, job->iv, children, out, n);
+	else
+		sha2_merkle_nodes(job->iv, children, out, n);
+}
+
+bool sha2_merkle_build(struct sha2_merkle *tree, const uint8_t *leaves, size_t nb_leaves, size_t threads) {
+	struct sha2 ctx;
+
+	*tree = (struct sha2_merkle){ 0 };
+	if (!nb_leaves)
+		return false;
+
+	// Every level but the root has at least one node more than the level above, so there are less than 2n nodes.
+	size_t nb_nodes = 0;
+	for (size_t n = nb_leaves;; n = (n + 1) / 2) {
+		nb_nodes += n;
+		if (n == 1)
+			break;
+	}
+	tree->nodes = malloc(nb_nodes * SHA2_MERKLE_NODE_SIZE);
+	if (!tree->nodes)
+		return false;
+	tree->nb_leaves = nb_leaves;
+	tree->nb_nodes  = nb_nodes;
+	ft_memcpy(tree->nodes, leaves, nb_leaves * SHA2_MERKLE_NODE_SIZE);
+
+	sha2_init(&ctx, SHA2_ALG_256);
+	threads = parallel_threads(threads);
+
+	struct sha2_merkle_job job   = { .iv = ctx.state_32, .lanes = sha2_select_lanes(SHA2_ALG_256) };
+	uint8_t               *level = tree->nodes;
+	for (size_t n = nb_leaves; n > 1; n = (n + 1) / 2) {
+		// The two children of a node are contiguous: together they are the 64 bytes block of the node.
+		job.level = level;
+		job.out   = level + n * SHA2_MERKLE_NODE_SIZE;
+		job.n     = n / 2;
+		parallel_for((job.n + SHA2_MERKLE_JOB - 1) / SHA2_MERKLE_JOB, threads, sha2_merkle_job, &job);
+		if (n % 2)
+			ft_memcpy(job.out + job.n * SHA2_MERKLE_NODE_SIZE, level + (n - 1) * SHA2_MERKLE_NODE_SIZE,
+			          SHA2_MERKLE_NODE_SIZE);
+		level = job.out;
+	}
+	return true;
+}
+
+bool sha2_merkle_proof(const struct sha2_merkle *tree, size_t index, uint8_t *proof, size_t *len) {
+	const uint8_t *level = tree->nodes;
+
+	if (index >= tree->nb_leaves)
+		return false;
+
+	*len = 0;
+	for (size_t n = tree->nb_leaves; n > 1; n = (n + 1) / 2) {
+		size_t sibling = index ^ 1;
+
+		if (sibling < n)
+			ft_memcpy(proof + (*len)++ * SHA2_MERKLE_NODE_SIZE, level + sibling * SHA2_MERKLE_NODE_SIZE,
+			          SHA2_MERKLE_NODE_SIZE);
+		level += n * SHA2_MERKLE_NODE_SIZE;
+		index /= 2;
+	}
+	return true;
+}
+
+bool sha2_merkle_verify(const uint8_t *root, const uint8_t *leaf, size_t index, size_t nb_leaves,
+                        const uint8_t *proof, size_t len) {
+	struct sha2 ctx;
+	uint8_t     node[SHA2_MERKLE_NODE_SIZE], children[SHA2_256_BLOCK_SIZE];
+	size_t      used = 0;
+
+	if (index >= nb_leaves)
+		return false;
+
+	sha2_init(&ctx, SHA2_ALG_256);
+	ft_memcpy(node, leaf, sizeof node);
+	for (size_t n = nb_leaves; n > 1; n = (n + 1) / 2, index /= 2) {
+		if ((index ^ 1) >= n)
+			continue;
+		if (used == len)
+			return false;
+
+		// The node goes on the left if its index is even.
+		ft_memcpy(children + (index & 1) * SHA2_MERKLE_NODE_SIZE, node, sizeof node);
+		ft_memcpy(children + !(index & 1) * SHA2_MERKLE_NODE_SIZE, proof + used++ * SHA2_MERKLE_NODE_SIZE,
+		          SHA2_MERKLE_NODE_SIZE);
+		sha2_merkle_nodes(ctx.state_32, children, node, 1);
+	}
+	uint8_t diff = 0;
+	for (size_t i = 0; i < sizeof node; i++) diff |= node[i] ^ root[i];
+	return used == len && !diff;
+}
+
+void sha2_merkle_free(struct sha2_merkle *tree) {
+	free(tree->nodes);
+	*tree = (struct sha2_merkle){ 0 };
+}
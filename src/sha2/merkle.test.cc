@@ -0,0 +1,75 @@
+#include "crypto.h"
+#include "random.hh"
+#include <gtest/gtest.h>
+#include <openssl/sha.h>
+#include <vector>
+
+typedef std::vector<uint8_t> bytes;
+
+// Root computed with OpenSSL, a level with an odd number of nodes promoting its last node.
+static bytes reference_root(const bytes &leaves) {
+	bytes level = leaves;
+
+	while (level.size() > SHA2_MERKLE_NODE_SIZE) {
+		size_t n = level.size() / SHA2_MERKLE_NODE_SIZE;
+		bytes  next((n + 1) / 2 * SHA2_MERKLE_NODE_SIZE);
+
+		for (size_t i = 0; i < n / 2; i++)
+			SHA256(level.data() + 2 * i * SHA2_MERKLE_NODE_SIZE, 2 * SHA2_MERKLE_NODE_SIZE,
+			       next.data() + i * SHA2_MERKLE_NODE_SIZE);
+		if (n % 2)
+			std::copy(level.end() - SHA2_MERKLE_NODE_SIZE, level.end(), next.end() - SHA2_MERKLE_NODE_SIZE);
+		level = next;
+	}
+	return level;
+}
+
+class SHA2_Merkle_Tests : public testing::TestWithParam<size_t> {};
+
+TEST_P(SHA2_Merkle_Tests, root_and_proofs) {
+	const size_t       nb_leaves = GetParam();
+	bytes              data      = rng::get_random_data(nb_leaves * SHA2_MERKLE_NODE_SIZE);
+	bytes              leaves(data.end() - nb_leaves * SHA2_MERKLE_NODE_SIZE, data.end());
+	struct sha2_merkle tree;
+
+	for (size_t threads : { 1, 3 }) {
+		ASSERT_TRUE(sha2_merkle_build(&tree, leaves.data(), nb_leaves, threads));
+		ASSERT_EQ(tree.nb_leaves, nb_leaves);
+		EXPECT_EQ(bytes(sha2_merkle_root(&tree), sha2_merkle_root(&tree) + SHA2_MERKLE_NODE_SIZE),
+		          reference_root(leaves));
+
+		// Every leaf of the small trees, a sample of the big ones.
+		const size_t step = nb_leaves > 1000 ? nb_leaves / 97 : 1;
+		for (size_t i = 0; i < nb_leaves; i += step) {
+			uint8_t        proof[SHA2_MERKLE_MAX_PROOF * SHA2_MERKLE_NODE_SIZE];
+			size_t         len;
+			const uint8_t *leaf = leaves.data() + i * SHA2_MERKLE_NODE_SIZE;
+
+			ASSERT_TRUE(sha2_merkle_proof(&tree, i, proof, &len));
+			EXPECT_TRUE(sha2_merkle_verify(sha2_merkle_root(&tree), leaf, i, nb_leaves, proof, len)) << i;
+
+			if (nb_leaves > 1) {
+				EXPECT_FALSE(sha2_merkle_verify(sha2_merkle_root(&tree), leaf, i ^ 1, nb_leaves, proof, len)) << i;
+				proof[len * SHA2_MERKLE_NODE_SIZE - 1] ^= 1;
+				EXPECT_FALSE(sha2_merkle_verify(sha2_merkle_root(&tree), leaf, i, nb_leaves, proof, len)) << i;
+			}
+			EXPECT_FALSE(sha2_merkle_verify(sha2_merkle_root(&tree), leaf, i, nb_leaves, proof, len + 1)) << i;
+		}
+
+		uint8_t proof[SHA2_MERKLE_MAX_PROOF * SHA2_MERKLE_NODE_SIZE];
+		size_t  len;
+		EXPECT_FALSE(sha2_merkle_proof(&tree, nb_leaves, proof, &len));
+		sha2_merkle_free(&tree);
+	}
+}
+
+// Sizes around the number of lanes and the size of a job, with odd levels at different heights.
+INSTANTIATE_TEST_SUITE_P(nb_leaves, SHA2_Merkle_Tests,
+                         testing::Values(1, 2, 3, 5, 16, 17, 31, 32, 33, 100, 1023, 8192, 8193, 20001));
+
+TEST(SHA2_Merkle_Tests, no_leaves) {
+	struct sha2_merkle tree;
+
+	EXPECT_FALSE(sha2_merkle_build(&tree, nullptr, 0, 1));
+	EXPECT_EQ(tree.nodes, nullptr);
+}
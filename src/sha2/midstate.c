@@ -0,0 +1,72 @@
+/**
+ * @file midstate.c
+ * @author Ghali Boucetta (gboucett@student.42.fr)
+ * @brief Export and import of the state of a SHA2 context, to resume a hash in another process.
+ * @date 2026-10-17
+ */
+
+#include "internal.h"
+#include "libft.h"
+
+#define SHA2_MIDSTATE_MAGIC 0x53 ///< First byte of an exported SHA2 state ('S').
+#define SHA2_MIDSTATE_FORMAT 1   ///< Version of the layout below.
+
+// Layout of an exported state (offsets in bytes), every integer is big endian.
+#define SHA2_MIDSTATE_OFF_ALG 2  ///< The algorithm (enum SHA2_ALG, 1 byte).
+#define SHA2_MIDSTATE_OFF_LEN 3  ///< Number of bytes fed to the context (128 bits).
+#define SHA2_MIDSTATE_OFF_STATE 19///< The chaining state, 8 words of 64 bits (zero extended for SHA2-224/256).
+#define SHA2_MIDSTATE_OFF_BLK 83 ///< The pending bytes, followed by zeros up to SHA2_MAX_BLOCK_SIZE.
+
+_Static_assert(SHA2_MIDSTATE_OFF_BLK + SHA2_MAX_BLOCK_SIZE == SHA2_MIDSTATE_SIZE, "wrong SHA2_MIDSTATE_SIZE");
+
+static void store_be(uint8_t *out, __uint128_t value, size_t size) {
+	for (size_t i = size; i--; value >>= 8) out[i] = (uint8_t) value;
+}
+
+static __uint128_t load_be(const uint8_t *in, size_t size) {
+	__uint128_t value = 0;
+
+	for (size_t i = 0; i < size; i++) value = value << 8 | in[i];
+	return value;
+}
+
+uint8_t *sha2_export(const struct sha2 *ctx, uint8_t *buf) {
+	const bool words_32 = ctx->block_size == SHA2_256_BLOCK_SIZE;
+
+	ft_memset(buf, 0, SHA2_MIDSTATE_SIZE);
+	buf[0]                     = SHA2_MIDSTATE_MAGIC;
+	buf[1]                     = SHA2_MIDSTATE_FORMAT;
+	buf[SHA2_MIDSTATE_OFF_ALG] = (uint8_t) ctx->alg;
+	store_be(buf + SHA2_MIDSTATE_OFF_LEN, ctx->len, 16);
+	for (size_t i = 0; i < 8; i++)
+		store_be(buf + SHA2_MIDSTATE_OFF_STATE + 8 * i, words_32 ? ctx->state_32[i] : ctx->state_64[i], 8);
+	ft_memcpy(buf + SHA2_MIDSTATE_OFF_BLK, ctx->blk, ctx->blk_len);
+	return buf;
+}
+
+bool sha2_import(struct sha2 *ctx, const uint8_t *buf) {
+	if (buf[0] != SHA2_MIDSTATE_MAGIC || buf[1] != SHA2_MIDSTATE_FORMAT)
+		return false;
+	if (!sha2_init(ctx, (enum SHA2_ALG) buf[SHA2_MIDSTATE_OFF_ALG]))
+		return false;
+
+	const bool words_32 = ctx->block_size == SHA2_256_BLOCK_SIZE;
+	for (size_t i = 0; i < 8; i++) {
+		uint64_t word = (uint64_t) load_be(buf + SHA2_MIDSTATE_OFF_STATE + 8 * i, 8);
+
+		if (words_32 && word >> 32) {
+			ft_memset(ctx, 0, sizeof *ctx);
+			return false;
+		}
+		if (words_32)
+			ctx->state_32[i] = (uint32_t) word;
+		else
+			ctx->state_64[i] = word;
+	}
+
+	// The pending bytes are the end of the message, after its last full block.
+	ctx->len     = load_be(buf + SHA2_MIDSTATE_OFF_LEN, 16);
+	ctx->blk_len = (size_t) (ctx->len % ctx->block_size);
+	ft_memcpy(ctx->blk, buf + SHA2_MIDSTATE_OFF_BLK, ctx->blk_len);
+	return true;
+}
@@ -0,0 +1,168 @@
+#include "bench.hh"
+#include "common.h"
+#include "crypto.h"
+#include "internal.h"
+#include <cstring>
+#include <vector>
+
+#define NB_BLOCKS 1024
+
+// Rolled compression functions (a loop over the rounds reading the constants from a table, with the whole message
+// schedule stored), kept here to compare them to the unrolled ones.
+static void sha2_256_compress_rolled(uint32_t *state, const uint8_t *blks, size_t nb) {
+	for (size_t n = 0; n < nb; n++, blks += SHA2_256_BLOCK_SIZE) {
+		uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+		uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+		uint32_t w[SHA2_256_NB_ROUNDS], t1, t2;
+
+		memcpy(w, blks, SHA2_256_BLOCK_SIZE);
+		for (size_t i = 0; i < 16; i++) w[i] = bswap_32(w[i]);
+		for (size_t i = 16; i < SHA2_256_NB_ROUNDS; i++)
+			w[i] = SSIG1_32(w[i - 2]) + w[i - 7] + SSIG0_32(w[i - 15]) + w[i - 16];
+
+		for (size_t i = 0; i < SHA2_256_NB_ROUNDS; i++) {
+			t1 = h + BSIG1_32(e) + Ch(e, f, g) + sha2_csts32[i] + w[i];
+			t2 = BSIG0_32(a) + Ma(a, b, c);
+			h  = g;
+			g  = f;
+			f  = e;
+			e  = d + t1;
+			d  = c;
+			c  = b;
+			b  = a;
+			a  = t1 + t2;
+		}
+
+		state[0] += a, state[1] += b, state[2] += c, state[3] += d;
+		state[4] += e, state[5] += f, state[6] += g, state[7] += h;
+	}
+}
+
+static void sha2_512_compress_rolled(uint64_t *state, const uint8_t *blks, size_t nb) {
+	for (size_t n = 0; n < nb; n++, blks += SHA2_512_BLOCK_SIZE) {
+		uint64_t a = state[0], b = state[1], c = state[2], d = state[3];
+		uint64_t e = state[4], f = state[5], g = state[6], h = state[7];
+		uint64_t w[SHA2_512_NB_ROUNDS], t1, t2;
+
+		memcpy(w, blks, SHA2_512_BLOCK_SIZE);
+		for (size_t i = 0; i < 16; i++) w[i] = bswap_64(w[i]);
+		for (size_t i = 16; i < SHA2_512_NB_ROUNDS; i++)
+			w[i] = SSIG1_64(w[i - 2]) + w[i - 7] + SSIG0_64(w[i - 15]) + w[i - 16];
+
+		for (size_t i = 0; i < SHA2_512_NB_ROUNDS; i++) {
+			t1 = h + BSIG1_64(e) + Ch(e, f, g) + sha2_csts64[i] + w[i];
+			t2 = BSIG0_64(a) + Ma(a, b, c);
+			h  = g;
+			g  = f;
+			f  = e;
+			e  = d + t1;
+			d  = c;
+			c  = b;
+			b  = a;
+			a  = t1 + t2;
+		}
+
+		state[0] += a, state[1] += b, state[2] += c, state[3] += d;
+		state[4] += e, state[5] += f, state[6] += g, state[7] += h;
+	}
+}
+
+static const std::vector<uint8_t> data(NB_BLOCKS * SHA2_512_BLOCK_SIZE, 0x42);
+
+BENCH(sha2_256_compress_rolled, NB_BLOCKS * SHA2_256_BLOCK_SIZE) {
+	uint32_t state[8] = {};
+
+	for (size_t i = 0; i < iterations; i++) sha2_256_compress_rolled(state, data.data(), NB_BLOCKS);
+	bench::do_not_optimize(state);
+	return true;
+}
+
+BENCH(sha2_256_compress_unrolled, NB_BLOCKS * SHA2_256_BLOCK_SIZE) {
+	uint32_t state[8] = {};
+
+	for (size_t i = 0; i < iterations; i++) sha2_256_compress_generic(state, data.data(), NB_BLOCKS);
+	bench::do_not_optimize(state);
+	return true;
+}
+
+BENCH(sha2_256_compress_shani, NB_BLOCKS * SHA2_256_BLOCK_SIZE) {
+#ifdef SHA2_HAVE_SHANI
+	uint32_t state[8] = {};
+
+	if (!cpu_has(CPU_FEATURE_SHA | CPU_FEATURE_SSE41))
+		return false;
+	for (size_t i = 0; i < iterations; i++) sha2_256_compress_shani(state, data.data(), NB_BLOCKS);
+	bench::do_not_optimize(state);
+	return true;
+#else
+	(void) iterations;
+	return false;
+#endif
+}
+
+BENCH(sha2_512_compress_rolled, NB_BLOCKS * SHA2_512_BLOCK_SIZE) {
+	uint64_t state[8] = {};
+
+	for (size_t i = 0; i < iterations; i++) sha2_512_compress_rolled(state, data.data(), NB_BLOCKS);
+	bench::do_not_optimize(state);
+	return true;
+}
+
+BENCH(sha2_512_compress_unrolled, NB_BLOCKS * SHA2_512_BLOCK_SIZE) {
+	uint64_t state[8] = {};
+
+	for (size_t i = 0; i < iterations; i++) sha2_512_compress_generic(state, data.data(), NB_BLOCKS);
+	bench::do_not_optimize(state);
+	return true;
+}
+
+BENCH(sha2_256_bytes_64KiB, NB_BLOCKS * SHA2_256_BLOCK_SIZE) {
+	uint8_t out[SHA2_256_DIGEST_SIZE];
+
+	for (size_t i = 0; i < iterations; i++)
+		sha2_bytes_raw(SHA2_ALG_256, data.data(), NB_BLOCKS * SHA2_256_BLOCK_SIZE, out);
+	bench::do_not_optimize(out);
+	return true;
+}
+
+BENCH(sha2_512_bytes_128KiB, NB_BLOCKS * SHA2_512_BLOCK_SIZE) {
+	uint8_t out[SHA2_512_DIGEST_SIZE];
+
+	for (size_t i = 0; i < iterations; i++)
+		sha2_bytes_raw(SHA2_ALG_512, data.data(), NB_BLOCKS * SHA2_512_BLOCK_SIZE, out);
+	bench::do_not_optimize(out);
+	return true;
+}
+
+#define NB_LEAVES (1 << 16)
+
+static const std::vector<uint8_t> leaves(NB_LEAVES * SHA2_256_DIGEST_SIZE, 0x42);
+
+// Every node of a Merkle tree hashed with sha2_bytes_raw, to compare with sha2_merkle_build.
+BENCH(sha2_256_merkle_bytes_raw, (NB_LEAVES - 1) * SHA2_256_BLOCK_SIZE) {
+	std::vector<uint8_t> nodes(2 * NB_LEAVES * SHA2_256_DIGEST_SIZE);
+
+	for (size_t i = 0; i < iterations; i++) {
+		uint8_t *level = nodes.data();
+
+		memcpy(level, leaves.data(), leaves.size());
+		for (size_t n = NB_LEAVES; n > 1; level += n * SHA2_256_DIGEST_SIZE, n /= 2)
+			for (size_t j = 0; j < n / 2; j++)
+				sha2_bytes_raw(SHA2_ALG_256, level + j * SHA2_256_BLOCK_SIZE, SHA2_256_BLOCK_SIZE,
+				               level + (n + j) * SHA2_256_DIGEST_SIZE);
+	}
+	bench::do_not_optimize(nodes.data());
+	return true;
+}
+
+BENCH(sha2_256_merkle_build, (NB_LEAVES - 1) * SHA2_256_BLOCK_SIZE) {
+	struct sha2_merkle tree;
+
+	for (size_t i = 0; i < iterations; i++) {
+		if (!sha2_merkle_build(&tree, leaves.data(), NB_LEAVES, 1))
+			return false;
+		bench::do_not_optimize(tree.nodes);
+		sha2_merkle_free(&tree);
+	}
+	return true;
+}
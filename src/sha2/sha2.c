@@ -34,32 +34,13 @@ static size_t get_size(enum SHA2_ALG alg) {
 	}
 }
 
-static bool __intermediate_sha2_bytes(const struct msg *msg, struct sha2 *ctx) {
-	struct blk *blks = get_blocks(msg, ctx->alg.block_size, ctx->alg.wanted_size, false);
-	if (blks == NULL)
-		return false;
-
-	size_t nb = blks->len / ctx->alg.block_size;
-	for (size_t i = 0; i < nb; i++)
-		sha2_update(ctx, blks->data + i * ctx->alg.block_size);
-
-	free(blks->data);
-	free(blks);
-	return true;
-}
-
 uint8_t *sha2_bytes_raw(enum SHA2_ALG alg, const uint8_t *bytes, size_t len, uint8_t *buf) {
 	struct sha2 ctx;
-	struct msg  msg = { .data = bytes, .len = len, .is_last_part = true, .filesize = len };
 
-	sha2_init(&ctx, alg);
-	if (!__intermediate_sha2_bytes(&msg, &ctx)) {
-		ft_memset(&ctx, 0, sizeof(ctx));
+	if (!sha2_init(&ctx, alg))
 		return NULL;
-	}
-	uint8_t *raw = sha2_final_raw(&ctx, buf);
-	sha2_free(&ctx, alg);
-	return raw;
+	sha2_update(&ctx, bytes, len);
+	return sha2_final_raw(&ctx, buf);
 }
 
 char *sha2_bytes(enum SHA2_ALG alg, const uint8_t *bytes, size_t len) {
@@ -85,49 +66,37 @@ char *sha2(enum SHA2_ALG alg, const char *input) {
 	return sha2_bytes(alg, bytes, len);
 }
 
-uint8_t *sha2_descriptor_raw(enum SHA2_ALG alg, int fd, uint8_t *buf) {
+static void sha2_update_descriptor(void *ctx, const uint8_t *data, size_t len) {
+	sha2_update(ctx, data, len);
+}
+
+uint8_t *sha2_descriptor_opts_raw(enum SHA2_ALG alg, int fd, const struct hash_io_opts *opts, uint8_t *buf) {
 	struct sha2 ctx;
-	sha2_init(&ctx, alg);
-
-	uint8_t    buffer[4096];
-	struct msg msg;
-
-	msg.is_last_part      = false;
-	bool        done_last = false;
-
-	ssize_t     ret;
-	__uint128_t filesize = 0;
-	for (ret = 0; (ret = read(fd, buffer, sizeof buffer)) > 0;) {
-		msg.data  = buffer;
-		msg.len   = ret;
-		filesize += ret;
-
-		if (ret < (ssize_t) sizeof buffer) {
-			msg.filesize     = filesize;
-			msg.is_last_part = true;
-			done_last        = true;
-		}
-
-		if (!__intermediate_sha2_bytes(&msg, &ctx)) {
-			ft_memset(&ctx, 0, sizeof(ctx));
-			return NULL;
-		}
+	if (!sha2_init(&ctx, alg))
+		return NULL;
+
+	if (!hash_descriptor(fd, opts, sha2_update_descriptor, &ctx)) {
+		ft_memset(&ctx, 0, sizeof(ctx));
+		return NULL;
 	}
-	if (!done_last) {
-		msg.filesize     = filesize;
-		msg.is_last_part = true;
-
-		msg.data = (uint8_t *) "";
-		msg.len  = 0;
-		if (!__intermediate_sha2_bytes(&msg, &ctx)) {
-			ft_memset(&ctx, 0, sizeof(ctx));
-			return NULL;
-		}
+	return sha2_final_raw(&ctx, buf);
+}
+
+uint8_t *sha2_descriptor_pipelined_raw(enum SHA2_ALG alg, int fd, const struct hash_io_opts *opts,
+                                       struct hash_io_stats *stats, uint8_t *buf) {
+	struct sha2 ctx;
+	if (!sha2_init(&ctx, alg))
+		return NULL;
+
+	if (!hash_descriptor_pipelined(fd, opts, stats, sha2_update_descriptor, &ctx)) {
+		ft_memset(&ctx, 0, sizeof(ctx));
+		return NULL;
 	}
+	return sha2_final_raw(&ctx, buf);
+}
 
-	uint8_t *raw = sha2_final_raw(&ctx, buf);
-	sha2_free(&ctx, alg);
-	return raw;
+uint8_t *sha2_descriptor_raw(enum SHA2_ALG alg, int fd, uint8_t *buf) {
+	return sha2_descriptor_opts_raw(alg, fd, NULL, buf);
 }
 
 char *sha2_descriptor(enum SHA2_ALG alg, int fd) {
@@ -4,6 +4,7 @@
 #include <fstream>
 #include <gtest/gtest.h>
 #include "digest.hh"
+#include "random.hh"
 
 namespace fs = std::filesystem;
 
@@ -155,4 +156,101 @@ TEST_P(SHA2_512_224_Tests, tests) {
 
 TEST_P(SHA2_512_256_Tests, tests) {
 	run_test();
-}
\ No newline at end of file
+}
+
+struct SHA2StreamingParams {
+	enum SHA2_ALG alg;
+	const EVP_MD *(*evp)();
+	const char *name;
+};
+
+std::ostream &operator<<(std::ostream &os, const SHA2StreamingParams &params) {
+	return os << params.name;
+}
+
+class SHA2_Streaming_Tests : public testing::TestWithParam<SHA2StreamingParams> {
+protected:
+	static std::vector<uint8_t> get_expected(const SHA2StreamingParams &params, const std::vector<uint8_t> &msg) {
+		const EVP_MD        *md = params.evp();
+		std::vector<uint8_t> result(EVP_MD_size(md), 0);
+
+		EXPECT_EQ(EVP_Digest(msg.data(), msg.size(), result.data(), nullptr, md, nullptr), 1);
+		return result;
+	}
+};
+
+TEST_P(SHA2_Streaming_Tests, random_chunks) {
+	const auto                            &params = GetParam();
+	std::uniform_int_distribution<size_t> chunk_distrib(0, 300);
+
+	for (size_t size: { 0, 1, 55, 56, 63, 64, 111, 112, 127, 128, 129, 1000, 4096, 10000 }) {
+		std::vector<uint8_t> msg(size);
+		std::generate(msg.begin(), msg.end(), [] { return static_cast<uint8_t>(rng::engine()); });
+
+		struct sha2 ctx {};
+		ASSERT_TRUE(sha2_init(&ctx, params.alg));
+		for (size_t off = 0; off < msg.size();) {
+			size_t len = std::min(chunk_distrib(rng::engine), msg.size() - off);
+			sha2_update(&ctx, msg.data() + off, len);
+			off += len;
+		}
+
+		std::vector<uint8_t> actual(ctx.digest_size);
+		sha2_final_raw(&ctx, actual.data());
+		EXPECT_EQ(actual, get_expected(params, msg)) << "size: " << size;
+	}
+}
+
+TEST_P(SHA2_Streaming_Tests, resume) {
+	const auto &params = GetParam();
+
+	for (size_t size: { 0, 1, 63, 64, 65, 127, 128, 129, 1000 }) {
+		std::vector<uint8_t> msg(size + 300);
+		std::generate(msg.begin(), msg.end(), [] { return static_cast<uint8_t>(rng::engine()); });
+
+		// Export after size bytes, then resume in a context holding garbage.
+		struct sha2 ctx {};
+		uint8_t     midstate[SHA2_MIDSTATE_SIZE];
+		ASSERT_TRUE(sha2_init(&ctx, params.alg));
+		sha2_update(&ctx, msg.data(), size);
+		sha2_export(&ctx, midstate);
+		memset(&ctx, 0xa5, sizeof ctx);
+
+		ASSERT_TRUE(sha2_import(&ctx, midstate));
+		sha2_update(&ctx, msg.data() + size, msg.size() - size);
+		std::vector<uint8_t> actual(ctx.digest_size);
+		sha2_final_raw(&ctx, actual.data());
+		EXPECT_EQ(actual, get_expected(params, msg)) << "size: " << size;
+	}
+}
+
+TEST(SHA2_Streaming_Tests, import_invalid) {
+	struct sha2 ctx {};
+	uint8_t     midstate[SHA2_MIDSTATE_SIZE];
+
+	ASSERT_TRUE(sha2_init(&ctx, SHA2_ALG_256));
+	sha2_export(&ctx, midstate);
+	for (size_t i : { 0, 1, 2 }) {
+		uint8_t bad[SHA2_MIDSTATE_SIZE];
+		memcpy(bad, midstate, sizeof bad);
+		bad[i] ^= 0x40;
+		EXPECT_FALSE(sha2_import(&ctx, bad)) << i;
+	}
+
+	// A 32 bits word with its upper half set.
+	midstate[19] = 1;
+	EXPECT_FALSE(sha2_import(&ctx, midstate));
+}
+
+TEST(SHA2_Streaming_Tests, unknown_algorithm) {
+	struct sha2 ctx {};
+	EXPECT_FALSE(sha2_init(&ctx, static_cast<enum SHA2_ALG>(42)));
+}
+
+INSTANTIATE_TEST_SUITE_P(streaming, SHA2_Streaming_Tests,
+                         testing::Values(SHA2StreamingParams{ SHA2_ALG_224, EVP_sha224, "sha224" },
+                                         SHA2StreamingParams{ SHA2_ALG_256, EVP_sha256, "sha256" },
+                                         SHA2StreamingParams{ SHA2_ALG_384, EVP_sha384, "sha384" },
+                                         SHA2StreamingParams{ SHA2_ALG_512, EVP_sha512, "sha512" },
+                                         SHA2StreamingParams{ SHA2_ALG_512_224, EVP_sha512_224, "sha512_224" },
+                                         SHA2StreamingParams{ SHA2_ALG_512_256, EVP_sha512_256, "sha512_256" }));
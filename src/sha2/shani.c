@@ -0,0 +1,102 @@
+/**
+ * @file shani.c
+ * @author Ghali Boucetta (gboucett@student.42.fr)
+ * @brief SHA-256 compression using the x86 SHA extensions.
+ * @date 2026-10-17
+ *
+ * The state is kept in two registers as {f, e, b, a} and {h, g, d, c} (lowest lane first), the layout expected by
+ * sha256rnds2.
+ * Each sha256rnds2 performs two rounds, the message schedule is computed four words at a time with
+ * sha256msg1/sha256msg2.
+ */
+
+#include "internal.h"
+
+#ifdef SHA2_HAVE_SHANI
+
+#	include <immintrin.h>
+
+#	define SHANI_TARGET __attribute__((target("sha,sse4.1")))
+
+// Four rounds using the schedule words in M and the constants starting at the round j * 4.
+#	define RNDS4(M, j)                                                                                                 \
+		{                                                                                                              \
+			tmp    = _mm_add_epi32(M, _mm_loadu_si128((const __m128i *) (sha2_csts32 + (j) * 4)));                     \
+			state1 = _mm_sha256rnds2_epu32(state1, state0, tmp);                                                       \
+			tmp    = _mm_shuffle_epi32(tmp, 0x0e);                                                                     \
+			state0 = _mm_sha256rnds2_epu32(state0, state1, tmp);                                                       \
+		}
+
+// Computes the next four schedule words in N from the previous ones (M is the latest, P the one before).
+#	define MSG2(N, M, P) N = _mm_sha256msg2_epu32(_mm_add_epi32(N, _mm_alignr_epi8(M, P, 4)), M)
+
+// Starts the computation of the schedule words four rounds ahead.
+#	define MSG1(P, M) P = _mm_sha256msg1_epu32(P, M)
+
+SHANI_TARGET void sha2_256_compress_shani(uint32_t *state, const uint8_t *blks, size_t nb) {
+	const __m128i bswap_mask = _mm_set_epi64x(0x0c0d0e0f08090a0b, 0x0405060700010203);
+	__m128i       state0, state1, tmp;
+	__m128i       m0, m1, m2, m3;
+
+	tmp    = _mm_loadu_si128((const __m128i *) state);      // {a, b, c, d}
+	state1 = _mm_loadu_si128((const __m128i *) (state + 4));// {e, f, g, h}
+	tmp    = _mm_shuffle_epi32(tmp, 0xb1);                  // {b, a, d, c}
+	state1 = _mm_shuffle_epi32(state1, 0x1b);               // {h, g, f, e}
+	state0 = _mm_alignr_epi8(tmp, state1, 8);               // {f, e, b, a}
+	state1 = _mm_blend_epi16(state1, tmp, 0xf0);            // {h, g, d, c}
+
+	for (size_t i = 0; i < nb; i++, blks += SHA2_256_BLOCK_SIZE) {
+		const __m128i abef = state0, cdgh = state1;
+
+		m0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) blks), bswap_mask);
+		m1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (blks + 16)), bswap_mask);
+		m2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (blks + 32)), bswap_mask);
+		m3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (blks + 48)), bswap_mask);
+
+		RNDS4(m0, 0);
+		RNDS4(m1, 1);
+		MSG1(m0, m1);
+		RNDS4(m2, 2);
+		MSG1(m1, m2);
+		RNDS4(m3, 3);
+		MSG2(m0, m3, m2);
+		MSG1(m2, m3);
+
+		for (size_t j = 4; j < 12; j += 4) {
+			RNDS4(m0, j);
+			MSG2(m1, m0, m3);
+			MSG1(m3, m0);
+			RNDS4(m1, j + 1);
+			MSG2(m2, m1, m0);
+			MSG1(m0, m1);
+			RNDS4(m2, j + 2);
+			MSG2(m3, m2, m1);
+			MSG1(m1, m2);
+			RNDS4(m3, j + 3);
+			MSG2(m0, m3, m2);
+			MSG1(m2, m3);
+		}
+
+		RNDS4(m0, 12);
+		MSG2(m1, m0, m3);
+		MSG1(m3, m0);
+		RNDS4(m1, 13);
+		MSG2(m2, m1, m0);
+		RNDS4(m2, 14);
+		MSG2(m3, m2, m1);
+		RNDS4(m3, 15);
+
+		state0 = _mm_add_epi32(state0, abef);
+		state1 = _mm_add_epi32(state1, cdgh);
+	}
+
+	tmp    = _mm_shuffle_epi32(state0, 0x1b);   // {a, b, e, f}
+	state1 = _mm_shuffle_epi32(state1, 0xb1);   // {g, h, c, d}
+	state0 = _mm_blend_epi16(tmp, state1, 0xf0);// {a, b, c, d}
+	state1 = _mm_alignr_epi8(state1, tmp, 8);   // {e, f, g, h}
+
+	_mm_storeu_si128((__m128i *) state, state0);
+	_mm_storeu_si128((__m128i *) (state + 4), state1);
+}
+
+#endif
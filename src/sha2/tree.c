@@ -0,0 +1,243 @@
+/**
+ * @file tree.c
+ * @author Ghali Boucetta (gboucett@student.42.fr)
+ * @brief Tree (Merkle) mode of SHA2: fixed size chunks hashed in parallel then combined into a root.
+ * @date 2026-10-17
+ *
+ * @see https://www.rfc-editor.org/rfc/rfc6962#section-2.1
+ */
+
+#include "internal.h"
+#include "libft.h"
+
+#include <fcntl.h>
+
+#define SHA2_TREE_LEAF 0x00///< Prefix of the leaves, so that a leaf can never be mistaken for a node.
+#define SHA2_TREE_NODE 0x01///< Prefix of the nodes.
+#define SHA2_TREE_PARALLEL_NODES 1024///< Levels with fewer nodes are combined on the calling thread.
+
+/**
+ * @brief State of a tree hash.
+ */
+struct sha2_tree {
+	enum SHA2_ALG alg;        ///< The algorithm.
+	size_t        digest_size;///< The size of the digests.
+	size_t        chunk_size; ///< The size of the chunks.
+	size_t        threads;    ///< The number of threads.
+
+	uint8_t      *leaves;   ///< The digests of the chunks hashed so far.
+	size_t        nb_leaves;///< The number of digests in leaves.
+	size_t        cap;      ///< The number of digests leaves can hold.
+
+	uint8_t      *batch;    ///< Chunks waiting to be hashed, when the input comes by small pieces.
+	size_t        batch_len;///< The number of bytes in batch.
+	size_t        batch_cap;///< The size of batch.
+	bool          error;    ///< Set if an allocation failed.
+};
+
+/**
+ * @brief A range of chunks hashed by parallel_for.
+ */
+struct sha2_tree_job {
+	struct sha2_tree *tree; ///< The tree.
+	const uint8_t    *data; ///< The first chunk.
+	size_t            len;  ///< The number of bytes, the last chunk can be partial.
+	uint8_t          *out;  ///< Where the first digest goes.
+	const uint8_t    *level;///< The nodes of the level being combined.
+};
+
+/**
+ * @brief Hash a prefix byte followed by data.
+ */
+static void sha2_tree_hash(enum SHA2_ALG alg, uint8_t prefix, const uint8_t *data, size_t len, uint8_t *out) {
+	struct sha2 ctx;
+
+	sha2_init(&ctx, alg);
+	sha2_update(&ctx, &prefix, 1);
+	sha2_update(&ctx, data, len);
+	sha2_final_raw(&ctx, out);
+}
+
+static void sha2_tree_leaf(void *arg, size_t i) {
+	const struct sha2_tree_job *job   = arg;
+	const size_t                chunk = job->tree->chunk_size;
+	const size_t                len   = job->len - i * chunk < chunk ? job->len - i * chunk : chunk;
+
+	sha2_tree_hash(job->tree->alg, SHA2_TREE_LEAF, job->data + i * chunk, len, job->out + i * job->tree->digest_size);
+}
+
+static void sha2_tree_node(void *arg, size_t i) {
+	const struct sha2_tree_job *job = arg;
+	const size_t                ds  = job->tree->digest_size;
+
+	// The two children are contiguous in the level below.
+	sha2_tree_hash(job->tree->alg, SHA2_TREE_NODE, job->level + 2 * i * ds, 2 * ds, job->out + i * ds);
+}
+
+/**
+ * @brief Hash consecutive chunks in parallel and append their digests to the leaves.
+ *
+ * @param len The number of bytes, only the last chunk of the input can be partial (or empty if the input is).
+ */
+static void sha2_tree_chunks(struct sha2_tree *tree, const uint8_t *data, size_t len) {
+	const size_t n = len ? (len + tree->chunk_size - 1) / tree->chunk_size : 1;
+
+	if (tree->nb_leaves + n > tree->cap) {
+		size_t   cap    = tree->cap ? tree->cap : 64;
+		while (cap < tree->nb_leaves + n) cap *= 2;
+		uint8_t *leaves = realloc(tree->leaves, cap * tree->digest_size);
+		if (!leaves) {
+			tree->error = true;
+			return;
+		}
+		tree->leaves = leaves;
+		tree->cap    = cap;
+	}
+
+	struct sha2_tree_job job = {
+		.tree = tree, .data = data, .len = len, .out = tree->leaves + tree->nb_leaves * tree->digest_size
+	};
+	parallel_for(n, tree->threads, sha2_tree_leaf, &job);
+	tree->nb_leaves += n;
+}
+
+/**
+ * @brief Feed data coming from a descriptor to the tree.
+ *
+ * @note Pieces big enough to keep every thread busy are hashed in place, the smaller ones are gathered in the batch.
+ */
+static void sha2_tree_update(void *ctx, const uint8_t *data, size_t len) {
+	struct sha2_tree *tree = ctx;
+
+	while (len && !tree->error) {
+		if (!tree->batch_len && len >= tree->batch_cap) {
+			size_t whole = len - len % tree->chunk_size;
+			sha2_tree_chunks(tree, data, whole);
+			data += whole;
+			len -= whole;
+			continue;
+		}
+
+		size_t copy = tree->batch_cap - tree->batch_len < len ? tree->batch_cap - tree->batch_len : len;
+		ft_memcpy(tree->batch + tree->batch_len, data, copy);
+		tree->batch_len += copy;
+		data += copy;
+		len -= copy;
+		if (tree->batch_len == tree->batch_cap) {
+			sha2_tree_chunks(tree, tree->batch, tree->batch_len);
+			tree->batch_len = 0;
+		}
+	}
+}
+
+/**
+ * @brief Initialize the tree.
+ *
+ * @return false if the algorithm is unknown or if the batch size does not fit in a size_t.
+ */
+static bool sha2_tree_init(struct sha2_tree *tree, enum SHA2_ALG alg, const struct sha2_tree_opts *opts) {
+	struct sha2 ctx;
+
+	if (!sha2_init(&ctx, alg))
+		return false;
+	*tree             = (struct sha2_tree){ 0 };
+	tree->alg         = alg;
+	tree->digest_size = ctx.digest_size;
+	tree->chunk_size  = opts && opts->chunk_size ? opts->chunk_size : SHA2_TREE_DEFAULT_CHUNK_SIZE;
+	tree->threads     = parallel_threads(opts ? opts->threads : 0);
+
+	// Two chunks per thread, so that a thread finishing early still has work.
+	if (__builtin_mul_overflow(2 * tree->threads, tree->chunk_size, &tree->batch_cap))
+		return false;
+	return tree->batch_cap >= tree->chunk_size;
+}
+
+/**
+ * @brief Combine the leaves into the root, level by level, then hand the leaves to the caller or free them.
+ *
+ * @return The root, or NULL if an allocation failed.
+ */
+static uint8_t *sha2_tree_final(struct sha2_tree *tree, uint8_t *root, uint8_t **chunks, size_t *nb_chunks) {
+	const size_t ds = tree->digest_size;
+
+	// An empty input is a single empty chunk.
+	if (!tree->error && !tree->nb_leaves)
+		sha2_tree_chunks(tree, (const uint8_t *) "", 0);
+
+	uint8_t *levels = tree->error ? NULL : malloc(2 * tree->nb_leaves * ds);
+	if (!levels) {
+		free(tree->leaves);
+		return NULL;
+	}
+
+	// Two buffers in turn, a level is never overwritten while the next one is computed from it.
+	uint8_t *level = levels, *next = levels + tree->nb_leaves * ds;
+	ft_memcpy(level, tree->leaves, tree->nb_leaves * ds);
+	for (size_t n = tree->nb_leaves; n > 1; n = (n + 1) / 2) {
+		struct sha2_tree_job job = { .tree = tree, .out = next, .level = level };
+
+		if (n / 2 >= SHA2_TREE_PARALLEL_NODES)
+			parallel_for(n / 2, tree->threads, sha2_tree_node, &job);
+		else
+			for (size_t i = 0; i < n / 2; i++) sha2_tree_node(&job, i);
+		if (n % 2)
+			ft_memcpy(next + n / 2 * ds, level + (n - 1) * ds, ds);
+
+		uint8_t *tmp = level;
+		level        = next;
+		next         = tmp;
+	}
+	ft_memcpy(root, level, ds);
+	free(levels);
+
+	if (nb_chunks)
+		*nb_chunks = tree->nb_leaves;
+	if (chunks)
+		*chunks = tree->leaves;
+	else
+		free(tree->leaves);
+	return root;
+}
+
+uint8_t *sha2_tree_bytes_raw(enum SHA2_ALG alg, const uint8_t *input, size_t input_size,
+                             const struct sha2_tree_opts *opts, uint8_t *root, uint8_t **chunks, size_t *nb_chunks) {
+	struct sha2_tree tree;
+
+	if (!sha2_tree_init(&tree, alg, opts))
+		return NULL;
+	if (input_size)
+		sha2_tree_chunks(&tree, input, input_size);
+	return sha2_tree_final(&tree, root, chunks, nb_chunks);
+}
+
+uint8_t *sha2_tree_descriptor_raw(enum SHA2_ALG alg, int fd, const struct sha2_tree_opts *opts, uint8_t *root,
+                                  uint8_t **chunks, size_t *nb_chunks) {
+	struct sha2_tree tree;
+
+	if (!sha2_tree_init(&tree, alg, opts))
+		return NULL;
+	tree.batch = malloc(tree.batch_cap);
+	if (!tree.batch)
+		return NULL;
+
+	bool ok = hash_descriptor(fd, opts ? opts->io : NULL, sha2_tree_update, &tree);
+	if (ok && tree.batch_len)
+		sha2_tree_chunks(&tree, tree.batch, tree.batch_len);
+	free(tree.batch);
+
+	if (!ok) {
+		free(tree.leaves);
+		return NULL;
+	}
+	return sha2_tree_final(&tree, root, chunks, nb_chunks);
+}
+
+uint8_t *sha2_tree_file_raw(enum SHA2_ALG alg, const char *filepath, const struct sha2_tree_opts *opts,
+                            uint8_t *root, uint8_t **chunks, size_t *nb_chunks) {
+	int fd = open(filepath, O_RDONLY);
+	if (fd == -1)
+		return NULL;
+	uint8_t *res = sha2_tree_descriptor_raw(alg, fd, opts, root, chunks, nb_chunks);
+	close(fd);
+	return res;
+}
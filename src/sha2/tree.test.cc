@@ -0,0 +1,145 @@
+#include "crypto.h"
+#include "random.hh"
+#include <cstdio>
+#include <gtest/gtest.h>
+#include <openssl/evp.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+typedef std::vector<uint8_t> bytes;
+
+static bytes evp_hash(const EVP_MD *md, uint8_t prefix, const uint8_t *data, size_t len) {
+	bytes       out(EVP_MD_get_size(md));
+	EVP_MD_CTX *ctx = EVP_MD_CTX_new();
+
+	EVP_DigestInit_ex(ctx, md, nullptr);
+	EVP_DigestUpdate(ctx, &prefix, 1);
+	EVP_DigestUpdate(ctx, data, len);
+	EVP_DigestFinal_ex(ctx, out.data(), nullptr);
+	EVP_MD_CTX_free(ctx);
+	return out;
+}
+
+// Merkle tree hash of the RFC 6962, with the split on the largest power of two smaller than n.
+static bytes reference_root(const EVP_MD *md, const bytes *leaves, size_t n) {
+	if (n == 1)
+		return *leaves;
+
+	size_t k = 1;
+	while (k * 2 < n) k *= 2;
+
+	bytes node = reference_root(md, leaves, k), right = reference_root(md, leaves + k, n - k);
+	node.insert(node.end(), right.begin(), right.end());
+	return evp_hash(md, 0x01, node.data(), node.size());
+}
+
+static std::vector<bytes> reference_leaves(const EVP_MD *md, const bytes &data, size_t chunk) {
+	std::vector<bytes> leaves;
+
+	for (size_t off = 0; off < data.size() || leaves.empty(); off += chunk)
+		leaves.push_back(evp_hash(md, 0x00, data.data() + off, std::min(chunk, data.size() - off)));
+	return leaves;
+}
+
+class SHA2_Tree_Tests : public testing::TestWithParam<size_t> {
+protected:
+	static constexpr size_t chunk = 1000;
+
+	void check(const EVP_MD *md, const bytes &data, const bytes &root, uint8_t *chunks, size_t nb_chunks,
+	           size_t chunk_size = chunk) {
+		auto leaves = reference_leaves(md, data, chunk_size);
+		EXPECT_EQ(root, reference_root(md, leaves.data(), leaves.size())) << data.size() << " bytes";
+
+		ASSERT_EQ(nb_chunks, leaves.size());
+		for (size_t i = 0; i < nb_chunks; i++)
+			EXPECT_EQ(bytes(chunks + i * root.size(), chunks + (i + 1) * root.size()), leaves[i]);
+		free(chunks);
+	}
+};
+
+TEST_P(SHA2_Tree_Tests, bytes) {
+	struct sha2_tree_opts opts = { .chunk_size = chunk, .threads = GetParam(), .io = nullptr };
+
+	for (size_t len : { 0, 1, 999, 1000, 1001, 4000, 5003, 7000, 17000, 100000 }) {
+		auto data = rng::get_random_data(len);
+
+		for (auto [alg, md] : { std::pair{ SHA2_ALG_256, EVP_sha256() }, std::pair{ SHA2_ALG_384, EVP_sha384() } }) {
+			bytes    root(EVP_MD_get_size(md));
+			uint8_t *chunks;
+			size_t   nb_chunks;
+
+			ASSERT_NE(sha2_tree_bytes_raw(alg, data.data(), data.size(), &opts, root.data(), &chunks, &nb_chunks),
+			          nullptr);
+			check(md, data, root, chunks, nb_chunks);
+		}
+	}
+}
+
+TEST_P(SHA2_Tree_Tests, descriptor) {
+	struct hash_io_opts   io   = { .flags = HASH_IO_NO_MMAP, .buffer_size = 0, .ring_depth = 0 };
+	struct sha2_tree_opts opts = { .chunk_size = chunk, .threads = GetParam(), .io = nullptr };
+	auto                  data = rng::get_random_data(300007);
+	FILE                 *file = std::tmpfile();
+
+	ASSERT_NE(file, nullptr);
+	ASSERT_EQ(write(fileno(file), data.data(), data.size()), (ssize_t) data.size());
+
+	// Mapped: the chunks are hashed in place. Read: they go through the batch.
+	for (auto io_opts : { (const struct hash_io_opts *) nullptr, (const struct hash_io_opts *) &io }) {
+		bytes    root(32);
+		uint8_t *chunks;
+		size_t   nb_chunks;
+
+		opts.io = io_opts;
+		ASSERT_EQ(lseek(fileno(file), 0, SEEK_SET), 0);
+		ASSERT_NE(sha2_tree_descriptor_raw(SHA2_ALG_256, fileno(file), &opts, root.data(), &chunks, &nb_chunks),
+		          nullptr);
+		check(EVP_sha256(), data, root, chunks, nb_chunks);
+	}
+	fclose(file);
+}
+
+TEST_P(SHA2_Tree_Tests, many_chunks) {
+	// Enough leaves for the lower levels to be combined in parallel.
+	struct sha2_tree_opts opts = { .chunk_size = 16, .threads = GetParam(), .io = nullptr };
+	auto                  data = rng::get_random_data(50000);
+	bytes                 root(32);
+	uint8_t              *chunks;
+	size_t                nb_chunks;
+
+	ASSERT_NE(sha2_tree_bytes_raw(SHA2_ALG_256, data.data(), data.size(), &opts, root.data(), &chunks, &nb_chunks),
+	          nullptr);
+	check(EVP_sha256(), data, root, chunks, nb_chunks, opts.chunk_size);
+}
+
+INSTANTIATE_TEST_SUITE_P(threads, SHA2_Tree_Tests, testing::Values(1, 3, 0));
+
+TEST(SHA2_Tree_Tests, single_chunk) {
+	// The root of a single chunk is its chunk digest, a chunk is verified by hashing it alone.
+	auto                  data = rng::get_random_data(10000);
+	struct sha2_tree_opts opts = { .chunk_size = 4096, .threads = 2, .io = nullptr };
+	bytes                 root(SHA2_MAX_DIGEST_SIZE), chunk_root(32);
+	uint8_t              *chunks;
+	size_t                nb_chunks;
+
+	ASSERT_NE(sha2_tree_bytes_raw(SHA2_ALG_256, data.data(), data.size(), &opts, root.data(), &chunks, &nb_chunks),
+	          nullptr);
+	ASSERT_GE(nb_chunks, 2u);
+	ASSERT_NE(sha2_tree_bytes_raw(SHA2_ALG_256, data.data() + 4096, 4096, &opts, chunk_root.data(), nullptr, nullptr),
+	          nullptr);
+	EXPECT_EQ(chunk_root, bytes(chunks + 32, chunks + 64));
+	free(chunks);
+
+	// The default chunk size, without asking for the chunks.
+	ASSERT_NE(sha2_tree_bytes_raw(SHA2_ALG_512, data.data(), data.size(), nullptr, root.data(), nullptr, nullptr),
+	          nullptr);
+	EXPECT_EQ(sha2_tree_bytes_raw((enum SHA2_ALG) 42, data.data(), data.size(), nullptr, root.data(), nullptr, nullptr),
+	          nullptr);
+	EXPECT_EQ(sha2_tree_file_raw(SHA2_ALG_256, "/nonexistent", nullptr, root.data(), nullptr, nullptr), nullptr);
+
+	// A chunk size whose batch would not fit in a size_t.
+	opts = { .chunk_size = SIZE_MAX / 2 + 9, .threads = 1, .io = nullptr };
+	EXPECT_EQ(sha2_tree_bytes_raw(SHA2_ALG_256, data.data(), data.size(), &opts, root.data(), nullptr, nullptr),
+	          nullptr);
+}
@@ -7,51 +7,140 @@
 
 #include "common.h"
 #include "internal.h"
+#include "libft.h"
 
-#define a0 ctx->state[0]
-#define b0 ctx->state[1]
-#define c0 ctx->state[2]
-#define d0 ctx->state[3]
-#define e0 ctx->state[4]
-#define f0 ctx->state[5]
-#define g0 ctx->state[6]
-#define h0 ctx->state[7]
+// Consts defined in RFC 6234 (SHA-256 and SHA-224)
+const uint32_t sha2_csts32[SHA2_256_NB_ROUNDS] = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+// Consts defined in RFC 6234 (SHA-512 and SHA-384)
+const uint64_t sha2_csts64[SHA2_512_NB_ROUNDS] = {
+	0x428a2f98d728ae22, 0x7137449123ef65cd, 0xb5c0fbcfec4d3b2f, 0xe9b5dba58189dbbc, 0x3956c25bf348b538,
+	0x59f111f1b605d019, 0x923f82a4af194f9b, 0xab1c5ed5da6d8118, 0xd807aa98a3030242, 0x12835b0145706fbe,
+	0x243185be4ee4b28c, 0x550c7dc3d5ffb4e2, 0x72be5d74f27b896f, 0x80deb1fe3b1696b1, 0x9bdc06a725c71235,
+	0xc19bf174cf692694, 0xe49b69c19ef14ad2, 0xefbe4786384f25e3, 0x0fc19dc68b8cd5b5, 0x240ca1cc77ac9c65,
+	0x2de92c6f592b0275, 0x4a7484aa6ea6e483, 0x5cb0a9dcbd41fbd4, 0x76f988da831153b5, 0x983e5152ee66dfab,
+	0xa831c66d2db43210, 0xb00327c898fb213f, 0xbf597fc7beef0ee4, 0xc6e00bf33da88fc2, 0xd5a79147930aa725,
+	0x06ca6351e003826f, 0x142929670a0e6e70, 0x27b70a8546d22ffc, 0x2e1b21385c26c926, 0x4d2c6dfc5ac42aed,
+	0x53380d139d95b3df, 0x650a73548baf63de, 0x766a0abb3c77b2a8, 0x81c2c92e47edaee6, 0x92722c851482353b,
+	0xa2bfe8a14cf10364, 0xa81a664bbc423001, 0xc24b8b70d0f89791, 0xc76c51a30654be30, 0xd192e819d6ef5218,
+	0xd69906245565a910, 0xf40e35855771202a, 0x106aa07032bbd1b8, 0x19a4c116b8d2d0c8, 0x1e376c085141ab53,
+	0x2748774cdf8eeb99, 0x34b0bcb5e19b48a8, 0x391c0cb3c5c95a63, 0x4ed8aa4ae3418acb, 0x5b9cca4f7763e373,
+	0x682e6ff3d6b2b8a3, 0x748f82ee5defb2fc, 0x78a5636f43172f60, 0x84c87814a1f0ab72, 0x8cc702081a6439ec,
+	0x90befffa23631e28, 0xa4506cebde82bde9, 0xbef9a3f7b2c67915, 0xc67178f2e372532b, 0xca273eceea26619c,
+	0xd186b8c721c0c207, 0xeada7dd6cde0eb1e, 0xf57d4f7fee6ed178, 0x06f067aa72176fba, 0x0a637dc5a2c898a6,
+	0x113f9804bef90dae, 0x1b710b35131c471b, 0x28db77f523047d84, 0x32caab7b40c72493, 0x3c9ebe0a15c9bebc,
+	0x431d67c49c100d4c, 0x4cc5d4becb3e42b6, 0x597f299cfc657e2a, 0x5fcb6fab3ad6faec, 0x6c44198c4a475817,
+};
+
+// One round with the constant k and the word w, the variables are rotated by the caller instead of being moved.
+#define ROUND(a, b, c, d, e, f, g, h, k, w)                                                                            \
+	{                                                                                                                  \
+		t1 = h + BSIG1(e) + Ch(e, f, g) + (k) + (w);                                                                   \
+		d += t1;                                                                                                       \
+		h  = t1 + BSIG0(a) + Ma(a, b, c);                                                                              \
+	}
+
+// Word of the first 16 rounds, taken as is from the block.
+#define LOAD(i) w[i]
+
+// Word of the next rounds, computed in place in the window of the last 16 words.
+#define SCHED(i) (w[(i) & 15] += SSIG1(w[((i) - 2) & 15]) + w[((i) - 7) & 15] + SSIG0(w[((i) - 15) & 15]))
 
 #define SSIG0(x) SSIG0_32(x)
 #define SSIG1(x) SSIG1_32(x)
 #define BSIG0(x) BSIG0_32(x)
 #define BSIG1(x) BSIG1_32(x)
 
-static void sha2_32_update(struct sha2_ctx_32 *ctx, uint32_t *blk) {
-	uint32_t a = a0, b = b0, c = c0, d = d0, e = e0, f = f0, g = g0, h = h0;
-
-	uint32_t w[64];
-	uint32_t t1, t2;
-
-	for (size_t i = 0; i < 16; i++) w[i] = bswap_32(blk[i]);
-	for (size_t i = 16; i < ctx->data.nb_rounds; i++) w[i] = SSIG1(w[i - 2]) + w[i - 7] + SSIG0(w[i - 15]) + w[i - 16];
-
-	for (size_t i = 0; i < ctx->data.nb_rounds; i++) {
-		t1 = h + BSIG1(e) + Ch(e, f, g) + ctx->cnsts[i] + w[i];
-		t2 = BSIG0(a) + Ma(a, b, c);
-		h  = g;
-		g  = f;
-		f  = e;
-		e  = d + t1;
-		d  = c;
-		c  = b;
-		b  = a;
-		a  = t1 + t2;
-	}
+static void sha2_32_update(uint32_t *state, const uint8_t *blk) {
+	uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+	uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+	uint32_t w[16], t1;
+
+	ft_memcpy(w, blk, sizeof w);// The block may not be aligned
+	for (size_t i = 0; i < 16; i++) w[i] = bswap_32(w[i]);
 
-	a0 += a;
-	b0 += b;
-	c0 += c;
-	d0 += d;
-	e0 += e;
-	f0 += f;
-	g0 += g;
-	h0 += h;
+	ROUND(a, b, c, d, e, f, g, h, 0x428a2f98, LOAD(0));
+	ROUND(h, a, b, c, d, e, f, g, 0x71374491, LOAD(1));
+	ROUND(g, h, a, b, c, d, e, f, 0xb5c0fbcf, LOAD(2));
+	ROUND(f, g, h, a, b, c, d, e, 0xe9b5dba5, LOAD(3));
+	ROUND(e, f, g, h, a, b, c, d, 0x3956c25b, LOAD(4));
+	ROUND(d, e, f, g, h, a, b, c, 0x59f111f1, LOAD(5));
+	ROUND(c, d, e, f, g, h, a, b, 0x923f82a4, LOAD(6));
+	ROUND(b, c, d, e, f, g, h, a, 0xab1c5ed5, LOAD(7));
+	ROUND(a, b, c, d, e, f, g, h, 0xd807aa98, LOAD(8));
+	ROUND(h, a, b, c, d, e, f, g, 0x12835b01, LOAD(9));
+	ROUND(g, h, a, b, c, d, e, f, 0x243185be, LOAD(10));
+	ROUND(f, g, h, a, b, c, d, e, 0x550c7dc3, LOAD(11));
+	ROUND(e, f, g, h, a, b, c, d, 0x72be5d74, LOAD(12));
+	ROUND(d, e, f, g, h, a, b, c, 0x80deb1fe, LOAD(13));
+	ROUND(c, d, e, f, g, h, a, b, 0x9bdc06a7, LOAD(14));
+	ROUND(b, c, d, e, f, g, h, a, 0xc19bf174, LOAD(15));
+	ROUND(a, b, c, d, e, f, g, h, 0xe49b69c1, SCHED(16));
+	ROUND(h, a, b, c, d, e, f, g, 0xefbe4786, SCHED(17));
+	ROUND(g, h, a, b, c, d, e, f, 0x0fc19dc6, SCHED(18));
+	ROUND(f, g, h, a, b, c, d, e, 0x240ca1cc, SCHED(19));
+	ROUND(e, f, g, h, a, b, c, d, 0x2de92c6f, SCHED(20));
+	ROUND(d, e, f, g, h, a, b, c, 0x4a7484aa, SCHED(21));
+	ROUND(c, d, e, f, g, h, a, b, 0x5cb0a9dc, SCHED(22));
+	ROUND(b, c, d, e, f, g, h, a, 0x76f988da, SCHED(23));
+	ROUND(a, b, c, d, e, f, g, h, 0x983e5152, SCHED(24));
+	ROUND(h, a, b, c, d, e, f, g, 0xa831c66d, SCHED(25));
+	ROUND(g, h, a, b, c, d, e, f, 0xb00327c8, SCHED(26));
+	ROUND(f, g, h, a, b, c, d, e, 0xbf597fc7, SCHED(27));
+	ROUND(e, f, g, h, a, b, c, d, 0xc6e00bf3, SCHED(28));
+	ROUND(d, e, f, g, h, a, b, c, 0xd5a79147, SCHED(29));
+	ROUND(c, d, e, f, g, h, a, b, 0x06ca6351, SCHED(30));
+	ROUND(b, c, d, e, f, g, h, a, 0x14292967, SCHED(31));
+	ROUND(a, b, c, d, e, f, g, h, 0x27b70a85, SCHED(32));
+	ROUND(h, a, b, c, d, e, f, g, 0x2e1b2138, SCHED(33));
+	ROUND(g, h, a, b, c, d, e, f, 0x4d2c6dfc, SCHED(34));
+	ROUND(f, g, h, a, b, c, d, e, 0x53380d13, SCHED(35));
+	ROUND(e, f, g, h, a, b, c, d, 0x650a7354, SCHED(36));
+	ROUND(d, e, f, g, h, a, b, c, 0x766a0abb, SCHED(37));
+	ROUND(c, d, e, f, g, h, a, b, 0x81c2c92e, SCHED(38));
+	ROUND(b, c, d, e, f, g, h, a, 0x92722c85, SCHED(39));
+	ROUND(a, b, c, d, e, f, g, h, 0xa2bfe8a1, SCHED(40));
+	ROUND(h, a, b, c, d, e, f, g, 0xa81a664b, SCHED(41));
+	ROUND(g, h, a, b, c, d, e, f, 0xc24b8b70, SCHED(42));
+	ROUND(f, g, h, a, b, c, d, e, 0xc76c51a3, SCHED(43));
+	ROUND(e, f, g, h, a, b, c, d, 0xd192e819, SCHED(44));
+	ROUND(d, e, f, g, h, a, b, c, 0xd6990624, SCHED(45));
+	ROUND(c, d, e, f, g, h, a, b, 0xf40e3585, SCHED(46));
+	ROUND(b, c, d, e, f, g, h, a, 0x106aa070, SCHED(47));
+	ROUND(a, b, c, d, e, f, g, h, 0x19a4c116, SCHED(48));
+	ROUND(h, a, b, c, d, e, f, g, 0x1e376c08, SCHED(49));
+	ROUND(g, h, a, b, c, d, e, f, 0x2748774c, SCHED(50));
+	ROUND(f, g, h, a, b, c, d, e, 0x34b0bcb5, SCHED(51));
+	ROUND(e, f, g, h, a, b, c, d, 0x391c0cb3, SCHED(52));
+	ROUND(d, e, f, g, h, a, b, c, 0x4ed8aa4a, SCHED(53));
+	ROUND(c, d, e, f, g, h, a, b, 0x5b9cca4f, SCHED(54));
+	ROUND(b, c, d, e, f, g, h, a, 0x682e6ff3, SCHED(55));
+	ROUND(a, b, c, d, e, f, g, h, 0x748f82ee, SCHED(56));
+	ROUND(h, a, b, c, d, e, f, g, 0x78a5636f, SCHED(57));
+	ROUND(g, h, a, b, c, d, e, f, 0x84c87814, SCHED(58));
+	ROUND(f, g, h, a, b, c, d, e, 0x8cc70208, SCHED(59));
+	ROUND(e, f, g, h, a, b, c, d, 0x90befffa, SCHED(60));
+	ROUND(d, e, f, g, h, a, b, c, 0xa4506ceb, SCHED(61));
+	ROUND(c, d, e, f, g, h, a, b, 0xbef9a3f7, SCHED(62));
+	ROUND(b, c, d, e, f, g, h, a, 0xc67178f2, SCHED(63));
+
+	state[0] += a;
+	state[1] += b;
+	state[2] += c;
+	state[3] += d;
+	state[4] += e;
+	state[5] += f;
+	state[6] += g;
+	state[7] += h;
 }
 
 #undef SSIG0
@@ -64,36 +153,103 @@ static void sha2_32_update(struct sha2_ctx_32 *ctx, uint32_t *blk) {
 #define BSIG0(x) BSIG0_64(x)
 #define BSIG1(x) BSIG1_64(x)
 
-static void sha2_64_update(struct sha2_ctx_64 *ctx, uint64_t *blk) {
-	uint64_t a = a0, b = b0, c = c0, d = d0, e = e0, f = f0, g = g0, h = h0;
-
-	uint64_t w[80];
-	uint64_t t1, t2;
-
-	for (size_t i = 0; i < 16; i++) w[i] = bswap_64(blk[i]);
-	for (size_t i = 16; i < ctx->data.nb_rounds; i++) w[i] = SSIG1(w[i - 2]) + w[i - 7] + SSIG0(w[i - 15]) + w[i - 16];
-
-	for (size_t i = 0; i < ctx->data.nb_rounds; i++) {
-		t1 = h + BSIG1(e) + Ch(e, f, g) + ctx->cnsts[i] + w[i];
-		t2 = BSIG0(a) + Ma(a, b, c);
-		h  = g;
-		g  = f;
-		f  = e;
-		e  = d + t1;
-		d  = c;
-		c  = b;
-		b  = a;
-		a  = t1 + t2;
-	}
+static void sha2_64_update(uint64_t *state, const uint8_t *blk) {
+	uint64_t a = state[0], b = state[1], c = state[2], d = state[3];
+	uint64_t e = state[4], f = state[5], g = state[6], h = state[7];
+	uint64_t w[16], t1;
+
+	ft_memcpy(w, blk, sizeof w);// The block may not be aligned
+	for (size_t i = 0; i < 16; i++) w[i] = bswap_64(w[i]);
 
-	a0 += a;
-	b0 += b;
-	c0 += c;
-	d0 += d;
-	e0 += e;
-	f0 += f;
-	g0 += g;
-	h0 += h;
+	ROUND(a, b, c, d, e, f, g, h, 0x428a2f98d728ae22, LOAD(0));
+	ROUND(h, a, b, c, d, e, f, g, 0x7137449123ef65cd, LOAD(1));
+	ROUND(g, h, a, b, c, d, e, f, 0xb5c0fbcfec4d3b2f, LOAD(2));
+	ROUND(f, g, h, a, b, c, d, e, 0xe9b5dba58189dbbc, LOAD(3));
+	ROUND(e, f, g, h, a, b, c, d, 0x3956c25bf348b538, LOAD(4));
+	ROUND(d, e, f, g, h, a, b, c, 0x59f111f1b605d019, LOAD(5));
+	ROUND(c, d, e, f, g, h, a, b, 0x923f82a4af194f9b, LOAD(6));
+	ROUND(b, c, d, e, f, g, h, a, 0xab1c5ed5da6d8118, LOAD(7));
+	ROUND(a, b, c, d, e, f, g, h, 0xd807aa98a3030242, LOAD(8));
+	ROUND(h, a, b, c, d, e, f, g, 0x12835b0145706fbe, LOAD(9));
+	ROUND(g, h, a, b, c, d, e, f, 0x243185be4ee4b28c, LOAD(10));
+	ROUND(f, g, h, a, b, c, d, e, 0x550c7dc3d5ffb4e2, LOAD(11));
+	ROUND(e, f, g, h, a, b, c, d, 0x72be5d74f27b896f, LOAD(12));
+	ROUND(d, e, f, g, h, a, b, c, 0x80deb1fe3b1696b1, LOAD(13));
+	ROUND(c, d, e, f, g, h, a, b, 0x9bdc06a725c71235, LOAD(14));
+	ROUND(b, c, d, e, f, g, h, a, 0xc19bf174cf692694, LOAD(15));
+	ROUND(a, b, c, d, e, f, g, h, 0xe49b69c19ef14ad2, SCHED(16));
+	ROUND(h, a, b, c, d, e, f, g, 0xefbe4786384f25e3, SCHED(17));
+	ROUND(g, h, a, b, c, d, e, f, 0x0fc19dc68b8cd5b5, SCHED(18));
+	ROUND(f, g, h, a, b, c, d, e, 0x240ca1cc77ac9c65, SCHED(19));
+	ROUND(e, f, g, h, a, b, c, d, 0x2de92c6f592b0275, SCHED(20));
+	ROUND(d, e, f, g, h, a, b, c, 0x4a7484aa6ea6e483, SCHED(21));
+	ROUND(c, d, e, f, g, h, a, b, 0x5cb0a9dcbd41fbd4, SCHED(22));
+	ROUND(b, c, d, e, f, g, h, a, 0x76f988da831153b5, SCHED(23));
+	ROUND(a, b, c, d, e, f, g, h, 0x983e5152ee66dfab, SCHED(24));
+	ROUND(h, a, b, c, d, e, f, g, 0xa831c66d2db43210, SCHED(25));
+	ROUND(g, h, a, b, c, d, e, f, 0xb00327c898fb213f, SCHED(26));
+	ROUND(f, g, h, a, b, c, d, e, 0xbf597fc7beef0ee4, SCHED(27));
+	ROUND(e, f, g, h, a, b, c, d, 0xc6e00bf33da88fc2, SCHED(28));
+	ROUND(d, e, f, g, h, a, b, c, 0xd5a79147930aa725, SCHED(29));
+	ROUND(c, d, e, f, g, h, a, b, 0x06ca6351e003826f, SCHED(30));
+	ROUND(b, c, d, e, f, g, h, a, 0x142929670a0e6e70, SCHED(31));
+	ROUND(a, b, c, d, e, f, g, h, 0x27b70a8546d22ffc, SCHED(32));
+	ROUND(h, a, b, c, d, e, f, g, 0x2e1b21385c26c926, SCHED(33));
+	ROUND(g, h, a, b, c, d, e, f, 0x4d2c6dfc5ac42aed, SCHED(34));
+	ROUND(f, g, h, a, b, c, d, e, 0x53380d139d95b3df, SCHED(35));
+	ROUND(e, f, g, h, a, b, c, d, 0x650a73548baf63de, SCHED(36));
+	ROUND(d, e, f, g, h, a, b, c, 0x766a0abb3c77b2a8, SCHED(37));
+	ROUND(c, d, e, f, g, h, a, b, 0x81c2c92e47edaee6, SCHED(38));
+	ROUND(b, c, d, e, f, g, h, a, 0x92722c851482353b, SCHED(39));
+	ROUND(a, b, c, d, e, f, g, h, 0xa2bfe8a14cf10364, SCHED(40));
+	ROUND(h, a, b, c, d, e, f, g, 0xa81a664bbc423001, SCHED(41));
+	ROUND(g, h, a, b, c, d, e, f, 0xc24b8b70d0f89791, SCHED(42));
+	ROUND(f, g, h, a, b, c, d, e, 0xc76c51a30654be30, SCHED(43));
+	ROUND(e, f, g, h, a, b, c, d, 0xd192e819d6ef5218, SCHED(44));
+	ROUND(d, e, f, g, h, a, b, c, 0xd69906245565a910, SCHED(45));
+	ROUND(c, d, e, f, g, h, a, b, 0xf40e35855771202a, SCHED(46));
+	ROUND(b, c, d, e, f, g, h, a, 0x106aa07032bbd1b8, SCHED(47));
+	ROUND(a, b, c, d, e, f, g, h, 0x19a4c116b8d2d0c8, SCHED(48));
+	ROUND(h, a, b, c, d, e, f, g, 0x1e376c085141ab53, SCHED(49));
+	ROUND(g, h, a, b, c, d, e, f, 0x2748774cdf8eeb99, SCHED(50));
+	ROUND(f, g, h, a, b, c, d, e, 0x34b0bcb5e19b48a8, SCHED(51));
+	ROUND(e, f, g, h, a, b, c, d, 0x391c0cb3c5c95a63, SCHED(52));
+	ROUND(d, e, f, g, h, a, b, c, 0x4ed8aa4ae3418acb, SCHED(53));
+	ROUND(c, d, e, f, g, h, a, b, 0x5b9cca4f7763e373, SCHED(54));
+	ROUND(b, c, d, e, f, g, h, a, 0x682e6ff3d6b2b8a3, SCHED(55));
+	ROUND(a, b, c, d, e, f, g, h, 0x748f82ee5defb2fc, SCHED(56));
+	ROUND(h, a, b, c, d, e, f, g, 0x78a5636f43172f60, SCHED(57));
+	ROUND(g, h, a, b, c, d, e, f, 0x84c87814a1f0ab72, SCHED(58));
+	ROUND(f, g, h, a, b, c, d, e, 0x8cc702081a6439ec, SCHED(59));
+	ROUND(e, f, g, h, a, b, c, d, 0x90befffa23631e28, SCHED(60));
+	ROUND(d, e, f, g, h, a, b, c, 0xa4506cebde82bde9, SCHED(61));
+	ROUND(c, d, e, f, g, h, a, b, 0xbef9a3f7b2c67915, SCHED(62));
+	ROUND(b, c, d, e, f, g, h, a, 0xc67178f2e372532b, SCHED(63));
+	ROUND(a, b, c, d, e, f, g, h, 0xca273eceea26619c, SCHED(64));
+	ROUND(h, a, b, c, d, e, f, g, 0xd186b8c721c0c207, SCHED(65));
+	ROUND(g, h, a, b, c, d, e, f, 0xeada7dd6cde0eb1e, SCHED(66));
+	ROUND(f, g, h, a, b, c, d, e, 0xf57d4f7fee6ed178, SCHED(67));
+	ROUND(e, f, g, h, a, b, c, d, 0x06f067aa72176fba, SCHED(68));
+	ROUND(d, e, f, g, h, a, b, c, 0x0a637dc5a2c898a6, SCHED(69));
+	ROUND(c, d, e, f, g, h, a, b, 0x113f9804bef90dae, SCHED(70));
+	ROUND(b, c, d, e, f, g, h, a, 0x1b710b35131c471b, SCHED(71));
+	ROUND(a, b, c, d, e, f, g, h, 0x28db77f523047d84, SCHED(72));
+	ROUND(h, a, b, c, d, e, f, g, 0x32caab7b40c72493, SCHED(73));
+	ROUND(g, h, a, b, c, d, e, f, 0x3c9ebe0a15c9bebc, SCHED(74));
+	ROUND(f, g, h, a, b, c, d, e, 0x431d67c49c100d4c, SCHED(75));
+	ROUND(e, f, g, h, a, b, c, d, 0x4cc5d4becb3e42b6, SCHED(76));
+	ROUND(d, e, f, g, h, a, b, c, 0x597f299cfc657e2a, SCHED(77));
+	ROUND(c, d, e, f, g, h, a, b, 0x5fcb6fab3ad6faec, SCHED(78));
+	ROUND(b, c, d, e, f, g, h, a, 0x6c44198c4a475817, SCHED(79));
+
+	state[0] += a;
+	state[1] += b;
+	state[2] += c;
+	state[3] += d;
+	state[4] += e;
+	state[5] += f;
+	state[6] += g;
+	state[7] += h;
 }
 
 #undef SSIG0
@@ -101,18 +257,58 @@ static void sha2_64_update(struct sha2_ctx_64 *ctx, uint64_t *blk) {
 #undef BSIG0
 #undef BSIG1
 
-#undef a0
-#undef b0
-#undef c0
-#undef d0
-#undef e0
-#undef f0
-#undef g0
-#undef h0
-
-void sha2_update(struct sha2 *ctx, void *data) {
-	if (ctx->alg.alg == SHA2_ALG_256 || ctx->alg.alg == SHA2_ALG_224)
-		sha2_32_update(ctx->ctx_32, (uint32_t *) data);
+#undef ROUND
+#undef LOAD
+#undef SCHED
+
+void sha2_256_compress_generic(uint32_t *state, const uint8_t *blks, size_t nb) {
+	for (size_t i = 0; i < nb; i++) sha2_32_update(state, blks + i * SHA2_256_BLOCK_SIZE);
+}
+
+void sha2_512_compress_generic(uint64_t *state, const uint8_t *blks, size_t nb) {
+	for (size_t i = 0; i < nb; i++) sha2_64_update(state, blks + i * SHA2_512_BLOCK_SIZE);
+}
+
+///< Compression function used for SHA-224 and SHA-256, selected once at load time.
+static void (*sha2_256_compress)(uint32_t *state, const uint8_t *blks, size_t nb) = sha2_256_compress_generic;
+
+__attribute__((constructor)) static void sha2_select_compress(void) {
+#ifdef SHA2_HAVE_SHANI
+	if (cpu_has(CPU_FEATURE_SHA | CPU_FEATURE_SSE41))
+		sha2_256_compress = sha2_256_compress_shani;
+#endif
+}
+
+void sha2_compress(struct sha2 *ctx, const uint8_t *blks, size_t nb) {
+	if (ctx->alg == SHA2_ALG_256 || ctx->alg == SHA2_ALG_224)
+		sha2_256_compress(ctx->state_32, blks, nb);
 	else
-		sha2_64_update(ctx->ctx_64, (uint64_t *) data);
+		sha2_512_compress_generic(ctx->state_64, blks, nb);
+}
+
+void sha2_update(struct sha2 *ctx, const uint8_t *data, size_t len) {
+	const size_t blk_size = ctx->block_size;
+
+	ctx->len += len;
+	if (ctx->blk_len) {// Complete the pending block first
+		size_t missing = blk_size - ctx->blk_len;
+
+		if (len < missing) {
+			ft_memcpy(ctx->blk + ctx->blk_len, data, len);
+			ctx->blk_len += len;
+			return;
+		}
+		ft_memcpy(ctx->blk + ctx->blk_len, data, missing);
+		sha2_compress(ctx, ctx->blk, 1);
+		ctx->blk_len = 0;
+		data        += missing;
+		len         -= missing;
+	}
+
+	size_t nb = len / blk_size;
+	sha2_compress(ctx, data, nb);
+
+	ctx->blk_len = len - nb * blk_size;
+	if (ctx->blk_len)
+		ft_memcpy(ctx->blk, data + nb * blk_size, ctx->blk_len);
 }
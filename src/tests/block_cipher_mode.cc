@@ -382,7 +382,7 @@ std::vector<uint8_t> BlockCipherModeTests::get_expected_result_cipher() {
 
 	size_t blk_len       = evp_blk_len == 1 ? 16 * evp_blk_len : evp_blk_len;
 	size_t rem           = expected_len % blk_len;
-	auto   expected_data = static_cast<uint8_t *>(malloc(expected_len + (evp_blk_len - rem)));
+	auto   expected_data = static_cast<uint8_t *>(malloc(expected_len + (blk_len - rem)));
 	if (expected_data == nullptr)
 		throw std::runtime_error("couldn't allocate memory");
 
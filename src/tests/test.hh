@@ -63,11 +63,17 @@ struct TestParams {
 	explicit TestParams(fs::path path) : is_file(true), filename(std::move(path)) {}
 
 	~TestParams() {
-		filename.~path();
+		if (is_file)
+			filename.~path();
+		else
+			string.~vector();
 	}
 
-	TestParams(const TestParams &other) : is_file(true) {
-		*this = other;
+	TestParams(const TestParams &other) : is_file(other.is_file) {
+		if (is_file)
+			new (&filename) fs::path(other.filename);
+		else
+			new (&string) std::vector<uint8_t>(other.string);
 	}
 
 	TestParams &operator=(const TestParams &other) {